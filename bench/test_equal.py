@@ -0,0 +1,18 @@
+import pyhepmc
+from pathlib import Path
+
+fn = Path(__file__).parent.parent / "tests" / "eposlhc_large.dat"
+
+with pyhepmc.open(fn) as f:
+    evt1 = f.read()
+
+with pyhepmc.open(fn) as f:
+    evt2 = f.read()
+
+
+def test_equal(benchmark):
+    assert benchmark(lambda: evt1 == evt2)
+
+
+def test_diff(benchmark):
+    assert benchmark(lambda: pyhepmc.diff(evt1, evt2)) is None
@@ -0,0 +1,74 @@
+import pyhepmc
+import numpy as np
+import pytest
+from pathlib import Path
+
+
+def synthetic(n):
+    # binary decay tree: particle k (1-based) decays into particles 2k and 2k+1
+    rng = np.random.default_rng(1)
+    px, py, pz = rng.normal(size=(3, n))
+    m = np.full(n, 0.1)
+    en = np.sqrt(px**2 + py**2 + pz**2 + m**2)
+    pid = np.full(n, 211, dtype=np.int32)
+    status = np.ones(n, dtype=np.int32)
+    parents = np.zeros((n, 2), dtype=np.int32)
+    k = np.arange(2, n)
+    parents[2:, 0] = (k + 1) // 2
+    parents[2:, 1] = (k + 1) // 2
+    return px, py, pz, en, m, pid, status, parents
+
+
+def from_file(fn):
+    with pyhepmc.open(fn) as f:
+        evt = f.read()
+    n = len(evt.particles)
+    columns = np.empty((5, n))
+    pid = np.empty(n, dtype=np.int32)
+    status = np.empty(n, dtype=np.int32)
+    parents = np.zeros((n, 2), dtype=np.int32)
+    for i, p in enumerate(evt.particles):
+        mom = p.momentum
+        columns[:, i] = (mom.px, mom.py, mom.pz, mom.e, p.generated_mass)
+        pid[i] = p.pid
+        status[i] = p.status
+        v = p.production_vertex
+        if v is not None and v.particles_in:
+            ids = [q.id for q in v.particles_in]
+            parents[i] = min(ids), max(ids)
+    return (*columns, pid, status, parents)
+
+
+inputs = {
+    "synthetic": synthetic(100_000),
+    "eposlhc_large": from_file(
+        Path(__file__).parent.parent / "tests" / "eposlhc_large.dat"
+    ),
+}
+
+
+@pytest.mark.parametrize("name", inputs)
+def test_from_hepevt(benchmark, name):
+    args = inputs[name]
+    evt = pyhepmc.GenEvent()
+
+    def run():
+        evt.from_hepevt(0, *args)
+
+    benchmark(run)
+
+
+@pytest.mark.parametrize("Writer", (pyhepmc.io.WriterAscii, pyhepmc.io.WriterAsciiFast))
+def test_write_batch(benchmark, Writer):
+    # 100 copies of the largest event, written from the arrays
+    args = inputs["eposlhc_large"]
+    nevent = 100
+    n = len(args[0])
+    batch = [np.tile(x, (nevent,) + (1,) * (x.ndim - 1)) for x in args]
+    offsets = np.arange(nevent + 1) * n
+
+    def run():
+        with Writer("bench_write_batch.dat") as w:
+            w.write_batch(*batch, offsets=offsets)
+
+    benchmark(run)
@@ -1,7 +1,9 @@
 import pyhepmc
-from pyhepmc.io import ReaderAscii
-from pyhepmc._core import pyiostream
+import pytest
+from pyhepmc.io import ReaderAscii, ReaderAsciiParallel, ReaderColumnar
+from pyhepmc._core import pyiostream, mmap_iostream
 from pathlib import Path
+from concurrent.futures import ThreadPoolExecutor
 
 
 fn = str(Path(__file__).parent.parent / "tests" / "pythia6.dat")
@@ -13,6 +15,10 @@ with pyhepmc.open("bench.dat", "w") as f:
     for _ in range(4000):
         f.write(evt)
 
+with pyhepmc.open("bench.col", "w", format="columnar") as f:
+    for _ in range(4000):
+        f.write(evt)
+
 
 def test_ReaderAscii(benchmark):
     def run():
@@ -36,3 +42,97 @@ def test_ReaderAscii_pyiostream(benchmark):
                         break
 
     benchmark(run)
+
+
+def test_ReaderAscii_mmap_iostream(benchmark):
+    def run():
+        with mmap_iostream("bench.dat") as s:
+            with ReaderAscii(s) as r:
+                while True:
+                    evt = r.read()
+                    if evt is None:
+                        break
+
+    benchmark(run)
+
+
+@pytest.mark.parametrize("nthreads", (1, 2, 4))
+def test_ReaderAscii_threads(benchmark, nthreads):
+    # every thread reads its own copy of the file; since the GIL is released
+    # while parsing, the time per run should stay roughly constant
+    def read(fn):
+        n = 0
+        with ReaderAscii(fn) as r:
+            for _ in r:
+                n += 1
+        return n
+
+    def run():
+        with ThreadPoolExecutor(nthreads) as ex:
+            return sum(ex.map(read, ["bench.dat"] * nthreads))
+
+    assert benchmark(run) == 4000 * nthreads
+
+
+@pytest.mark.parametrize("prefetch", (False, True))
+@pytest.mark.parametrize("suffix", ("", ".gz", ".bz2"))
+def test_open_prefetch(benchmark, prefetch, suffix):
+    fn = "bench.dat" + suffix
+    if suffix:
+        with pyhepmc.open(fn, "w") as f:
+            for _ in range(4000):
+                f.write(evt)
+
+    def run():
+        with pyhepmc.open(fn, prefetch=prefetch) as f:
+            for _ in f:
+                pass
+
+    benchmark(run)
+
+
+@pytest.mark.parametrize("threads", (1, 2, 4, 8))
+def test_ReaderAsciiParallel(benchmark, threads):
+    def run():
+        n = 0
+        with ReaderAsciiParallel("bench.dat", threads) as r:
+            for _ in r:
+                n += 1
+        return n
+
+    assert benchmark(run) == 4000
+
+
+def test_ReaderColumnar(benchmark):
+    def run():
+        n = 0
+        with ReaderColumnar("bench.col") as r:
+            for _ in r:
+                n += 1
+        return n
+
+    assert benchmark(run) == 4000
+
+
+@pytest.mark.parametrize("Writer", (pyhepmc.io.WriterAscii, pyhepmc.io.WriterAsciiFast))
+def test_write(benchmark, Writer):
+    def run():
+        with Writer("bench_write.dat") as w:
+            for _ in range(4000):
+                w.write(evt)
+
+    benchmark(run)
+
+
+@pytest.mark.parametrize("reuse", (False, True))
+def test_ReaderAscii_reuse(benchmark, reuse):
+    # with reuse, the GenEvent and the capacity of its particle and vertex
+    # containers are kept, only the particles and vertices are allocated again
+    def run():
+        n = 0
+        with ReaderAscii("bench.dat") as r:
+            for evt in r.iterate(reuse=reuse):
+                n += len(evt.particles)
+        return n
+
+    assert benchmark(run) == 4000 * len(evt.particles)
@@ -19,6 +19,9 @@
 #include <pybind11/pytypes.h>
 #include <sstream>
 #include <stdexcept>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
 
 MEMBER_ACCESSOR(A1, HepMC3::Attribute, m_event, const HepMC3::GenEvent*)
 MEMBER_ACCESSOR(A2, HepMC3::Attribute, m_particle, HepMC3::GenParticlePtr)
@@ -39,27 +42,50 @@ py::object value_to_python(GenPdfInfoPtr a) { return py::cast(a); }
 py::object value_to_python(HEPRUPAttributePtr a) { return py::cast(a); }
 py::object value_to_python(HEPEUPAttributePtr a) { return py::cast(a); }
 
+// Must cover all C++ attribute types derived from Attribute.
+// AssociatedParticle derives from IntAttribute; must come first.
+using AttributeTypes = boost::mp11::mp_list<
+    GenCrossSection, GenHeavyIon, GenPdfInfo, HEPRUPAttribute, HEPEUPAttribute,
+    AssociatedParticle, BoolAttribute, IntAttribute, LongAttribute, DoubleAttribute,
+    FloatAttribute, StringAttribute, CharAttribute, LongLongAttribute,
+    LongDoubleAttribute, UIntAttribute, ULongLongAttribute, VectorCharAttribute,
+    VectorFloatAttribute, VectorLongDoubleAttribute, VectorLongLongAttribute,
+    VectorUIntAttribute, VectorULongAttribute, VectorULongLongAttribute,
+    VectorIntAttribute, VectorLongIntAttribute, VectorDoubleAttribute,
+    VectorStringAttribute>;
+
+using attribute_converter = py::object (*)(AttributePtr&);
+
+// Converters keyed on the dynamic type of the attribute, so that the converter
+// for the exact type is found with one hash lookup.
+const std::unordered_map<std::type_index, attribute_converter>& attribute_converters() {
+  using namespace boost::mp11;
+  static const auto table = [] {
+    std::unordered_map<std::type_index, attribute_converter> t;
+    // use mp_identity to make sure that default ctor is a noop
+    mp_for_each<mp_transform<mp_identity, AttributeTypes>>([&t](auto x) {
+      using AttributeType = typename decltype(x)::type;
+      t.emplace(typeid(AttributeType), [](AttributePtr& a) {
+        return value_to_python(std::static_pointer_cast<AttributeType>(a));
+      });
+    });
+    return t;
+  }();
+  return table;
+}
+
 py::object attribute_to_python(AttributePtr& a) {
   using namespace boost::mp11;
 
   if (!a->is_parsed()) return py::cast(UnparsedAttribute{a});
 
-  // Must cover all C++ attribute types derived from Attribute.
-  // AssociatedParticle derives from IntAttribute; must come first.
-
-  using RawTypes =
-      mp_list<GenCrossSection, GenHeavyIon, GenPdfInfo, HEPRUPAttribute,
-              HEPEUPAttribute, AssociatedParticle, BoolAttribute, IntAttribute,
-              LongAttribute, DoubleAttribute, FloatAttribute, StringAttribute,
-              CharAttribute, LongLongAttribute, LongDoubleAttribute, UIntAttribute,
-              ULongLongAttribute, VectorCharAttribute, VectorFloatAttribute,
-              VectorLongDoubleAttribute, VectorLongLongAttribute, VectorUIntAttribute,
-              VectorULongAttribute, VectorULongLongAttribute, VectorIntAttribute,
-              VectorLongIntAttribute, VectorDoubleAttribute, VectorStringAttribute>;
-  // use mp_identity to make sure that default ctor is a noop
-  using Types = mp_transform<mp_identity, RawTypes>;
+  const auto& converters = attribute_converters();
+  auto it = converters.find(typeid(*a));
+  if (it != converters.end()) return it->second(a);
+
+  // slow path for user types derived from one of the attribute types
   py::object result;
-  mp_for_each<Types>([&](auto t) {
+  mp_for_each<mp_transform<mp_identity, AttributeTypes>>([&](auto t) {
     using AttributeType = typename decltype(t)::type;
     if (result) return;
     if (auto x = std::dynamic_pointer_cast<AttributeType>(a))
@@ -94,4 +94,17 @@ py::ssize_t AttributesView::len() {
   return n;
 }
 
+py::dict all_attributes(GenEvent& event) {
+  py::dict result;
+  auto& amap = accessor::accessMember<MA1>(event).get();
+  for (auto& kv : amap) {
+    if (kv.second.empty()) continue;
+    py::dict values;
+    for (auto& kv2 : kv.second)
+      values[py::int_(kv2.first)] = attribute_to_python(kv2.second);
+    result[py::str(kv.first)] = values;
+  }
+  return result;
+}
+
 } // namespace HepMC3
@@ -63,6 +63,9 @@ struct RunInfoAttributesView {
 py::object attribute_to_python(AttributePtr& a);
 AttributePtr attribute_from_python(py::object obj);
 
+// converts all attributes of the event in one pass over its attribute map
+py::dict all_attributes(GenEvent& event);
+
 } // namespace HepMC3
 
 #endif
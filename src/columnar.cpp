@@ -0,0 +1,655 @@
+#include "columnar.hpp"
+#include <HepMC3/Data/GenRunInfoData.h>
+#include <HepMC3/GenEvent.h>
+#include <HepMC3/GenRunInfo.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef PYHEPMC_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef PYHEPMC_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace HepMC3 {
+
+namespace {
+
+const char magic[8] = {'P', 'Y', 'H', 'E', 'P', 'M', 'C', 'C'};
+constexpr std::uint32_t version = 1;
+constexpr std::uint32_t byte_order_mark = 0x01020304;
+
+enum column : int {
+  // one value per event
+  EVENT_NUMBER,
+  MOMENTUM_UNIT,
+  LENGTH_UNIT,
+  EVENT_POS, // four values per event
+  N_PARTICLES,
+  N_VERTICES,
+  N_WEIGHTS,
+  N_LINKS,
+  N_ATTRIBUTES,
+  // one value per particle
+  PARTICLE_PID,
+  PARTICLE_STATUS,
+  PARTICLE_IS_MASS_SET,
+  PARTICLE_MASS,
+  PARTICLE_PX,
+  PARTICLE_PY,
+  PARTICLE_PZ,
+  PARTICLE_E,
+  // one value per vertex
+  VERTEX_STATUS,
+  VERTEX_X,
+  VERTEX_Y,
+  VERTEX_Z,
+  VERTEX_T,
+  // one value per weight
+  WEIGHTS,
+  // one value per link
+  LINKS1,
+  LINKS2,
+  // one value per attribute
+  ATTRIBUTE_ID,
+  ATTRIBUTE_NAME_SIZE,
+  ATTRIBUTE_STRING_SIZE,
+  // one value per byte of attribute names and strings
+  ATTRIBUTE_NAME,
+  ATTRIBUTE_STRING,
+  NCOLUMNS
+};
+
+enum type : std::uint8_t { U8, I32, I64, F64 };
+
+struct column_spec {
+  const char* name;
+  type dtype;
+};
+
+const column_spec schema[NCOLUMNS] = {
+    {"event_number", I32},
+    {"momentum_unit", I32},
+    {"length_unit", I32},
+    {"event_pos", F64},
+    {"n_particles", I64},
+    {"n_vertices", I64},
+    {"n_weights", I64},
+    {"n_links", I64},
+    {"n_attributes", I64},
+    {"particle_pid", I32},
+    {"particle_status", I32},
+    {"particle_is_mass_set", U8},
+    {"particle_mass", F64},
+    {"particle_px", F64},
+    {"particle_py", F64},
+    {"particle_pz", F64},
+    {"particle_e", F64},
+    {"vertex_status", I32},
+    {"vertex_x", F64},
+    {"vertex_y", F64},
+    {"vertex_z", F64},
+    {"vertex_t", F64},
+    {"weights", F64},
+    {"links1", I32},
+    {"links2", I32},
+    {"attribute_id", I32},
+    {"attribute_name_size", I64},
+    {"attribute_string_size", I64},
+    {"attribute_name", U8},
+    {"attribute_string", U8},
+};
+
+std::size_t itemsize(type t) {
+  switch (t) {
+    case U8: return 1;
+    case I32: return 4;
+    case I64: return 8;
+    case F64: return 8;
+  }
+  return 0;
+}
+
+// offsets into the variable-length columns of a batch
+enum offset : int {
+  O_PARTICLES,
+  O_VERTICES,
+  O_WEIGHTS,
+  O_LINKS,
+  O_ATTRIBUTES,
+  O_ATTRIBUTE_NAME,
+  O_ATTRIBUTE_STRING,
+};
+
+enum codec : std::uint8_t { RAW = 0, ZLIB = 1, ZSTD = 2, SHUFFLE = 0x80 };
+
+void corrupt() { throw std::runtime_error("corrupt or truncated columnar file"); }
+
+template <class T>
+void put(std::vector<char>& c, T value) {
+  const auto n = c.size();
+  c.resize(n + sizeof(T));
+  std::memcpy(&c[n], &value, sizeof(T));
+}
+
+template <class T>
+const T* get(const columnar::column_list& columns, int i) {
+  return reinterpret_cast<const T*>(columns[i].data());
+}
+
+#if defined(PYHEPMC_HAS_ZSTD) || defined(PYHEPMC_HAS_ZLIB)
+// groups the bytes of equal significance, which makes numbers with similar
+// exponents compress much better
+std::vector<char> shuffle(const std::vector<char>& in, std::size_t size) {
+  std::vector<char> out(in.size());
+  const auto n = in.size() / size;
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t j = 0; j < size; ++j) out[j * n + i] = in[i * size + j];
+  return out;
+}
+#endif
+
+std::vector<char> unshuffle(const std::vector<char>& in, std::size_t size) {
+  std::vector<char> out(in.size());
+  const auto n = in.size() / size;
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t j = 0; j < size; ++j) out[i * size + j] = in[j * n + i];
+  return out;
+}
+
+std::uint8_t encode(const std::vector<char>& raw, std::size_t size, int level,
+                    std::vector<char>& out) {
+#if defined(PYHEPMC_HAS_ZSTD) || defined(PYHEPMC_HAS_ZLIB)
+  if (level > 0 && raw.size() >= 64) {
+    std::uint8_t flags = 0;
+    const std::vector<char>* in = &raw;
+    std::vector<char> shuffled;
+    if (size > 1) {
+      shuffled = shuffle(raw, size);
+      in = &shuffled;
+      flags = SHUFFLE;
+    }
+#ifdef PYHEPMC_HAS_ZSTD
+    out.resize(ZSTD_compressBound(in->size()));
+    const auto n = ZSTD_compress(out.data(), out.size(), in->data(), in->size(), level);
+    if (ZSTD_isError(n))
+      throw std::runtime_error(std::string("zstd error: ") + ZSTD_getErrorName(n));
+    flags |= ZSTD;
+#else
+    uLongf n = compressBound(in->size());
+    out.resize(n);
+    if (compress2(reinterpret_cast<Bytef*>(out.data()), &n,
+                  reinterpret_cast<const Bytef*>(in->data()), in->size(),
+                  std::min(level, 9)) != Z_OK)
+      throw std::runtime_error("zlib compression failed");
+    flags |= ZLIB;
+#endif
+    out.resize(n);
+    if (out.size() < raw.size()) return flags;
+  }
+#else
+  (void)size;
+  (void)level;
+#endif
+  out = raw;
+  return RAW;
+}
+
+void decode(std::uint8_t flags, std::vector<char>& stored, std::size_t size,
+            std::vector<char>& out) {
+  switch (flags & ~SHUFFLE) {
+    case RAW: out.swap(stored); break;
+#ifdef PYHEPMC_HAS_ZLIB
+    case ZLIB: {
+      uLongf n = out.size();
+      if (uncompress(reinterpret_cast<Bytef*>(out.data()), &n,
+                     reinterpret_cast<const Bytef*>(stored.data()),
+                     stored.size()) != Z_OK ||
+          n != out.size())
+        corrupt();
+    } break;
+#endif
+#ifdef PYHEPMC_HAS_ZSTD
+    case ZSTD: {
+      const auto n = ZSTD_decompress(out.data(), out.size(), stored.data(), stored.size());
+      if (ZSTD_isError(n) || n != out.size()) corrupt();
+    } break;
+#endif
+    default:
+      throw std::runtime_error(
+          "columnar file uses a compression which is not available in this build");
+  }
+  if (flags & SHUFFLE) {
+    if (out.size() % size != 0) corrupt();
+    out = unshuffle(out, size);
+  }
+}
+
+} // namespace
+
+WriterColumnar::WriterColumnar(const std::string& filename, GenRunInfoPtr run,
+                               int batch_size, int compression)
+    : file_(new std::ofstream(filename, std::ios::binary))
+    , stream_(file_.get())
+    , batch_size_(batch_size)
+    , compression_(compression)
+    , columns_(NCOLUMNS) {
+  if (!*file_) throw std::runtime_error("cannot open file " + filename);
+  if (batch_size < 1) throw std::invalid_argument("batch_size must be positive");
+  set_run_info(run);
+}
+
+WriterColumnar::WriterColumnar(std::ostream& stream, GenRunInfoPtr run, int batch_size,
+                               int compression)
+    : stream_(&stream)
+    , batch_size_(batch_size)
+    , compression_(compression)
+    , columns_(NCOLUMNS) {
+  if (batch_size < 1) throw std::invalid_argument("batch_size must be positive");
+  set_run_info(run);
+}
+
+WriterColumnar::~WriterColumnar() {
+  try {
+    close();
+  } catch (...) {}
+}
+
+void WriterColumnar::write(const void* p, std::size_t n) {
+  stream_->write(static_cast<const char*>(p), n);
+  bytes_ += n;
+}
+
+void WriterColumnar::write_header() {
+  header_written_ = true;
+  write(magic, sizeof(magic));
+  write(&version, 4);
+  write(&byte_order_mark, 4);
+  const std::uint32_t ncolumns = NCOLUMNS;
+  write(&ncolumns, 4);
+  for (const auto& spec : schema) {
+    const std::uint16_t n = std::strlen(spec.name);
+    write(&n, 2);
+    write(spec.name, n);
+    write(&spec.dtype, 1);
+  }
+
+  const std::uint8_t has_run_info = run_info() ? 1 : 0;
+  write(&has_run_info, 1);
+  if (!has_run_info) return;
+  GenRunInfoData data;
+  run_info()->write_data(data);
+  for (const auto* list : {&data.weight_names, &data.tool_name, &data.tool_version,
+                           &data.tool_description, &data.attribute_name,
+                           &data.attribute_string}) {
+    const std::uint32_t n = list->size();
+    write(&n, 4);
+    for (const auto& s : *list) {
+      const std::uint32_t size = s.size();
+      write(&size, 4);
+      write(s.data(), size);
+    }
+  }
+}
+
+void WriterColumnar::write_event(const GenEvent& event) {
+  if (closed_) throw std::runtime_error("writer is closed");
+  if (!header_written_) {
+    if (!run_info()) set_run_info(event.run_info());
+    write_header();
+  }
+
+  event.write_data(data_);
+  auto& c = columns_;
+  put<std::int32_t>(c[EVENT_NUMBER], data_.event_number);
+  put<std::int32_t>(c[MOMENTUM_UNIT], data_.momentum_unit);
+  put<std::int32_t>(c[LENGTH_UNIT], data_.length_unit);
+  put(c[EVENT_POS], data_.event_pos.x());
+  put(c[EVENT_POS], data_.event_pos.y());
+  put(c[EVENT_POS], data_.event_pos.z());
+  put(c[EVENT_POS], data_.event_pos.t());
+  put<std::int64_t>(c[N_PARTICLES], data_.particles.size());
+  put<std::int64_t>(c[N_VERTICES], data_.vertices.size());
+  put<std::int64_t>(c[N_WEIGHTS], data_.weights.size());
+  put<std::int64_t>(c[N_LINKS], data_.links1.size());
+  put<std::int64_t>(c[N_ATTRIBUTES], data_.attribute_id.size());
+  for (const auto& p : data_.particles) {
+    put<std::int32_t>(c[PARTICLE_PID], p.pid);
+    put<std::int32_t>(c[PARTICLE_STATUS], p.status);
+    put<std::uint8_t>(c[PARTICLE_IS_MASS_SET], p.is_mass_set);
+    put(c[PARTICLE_MASS], p.mass);
+    put(c[PARTICLE_PX], p.momentum.px());
+    put(c[PARTICLE_PY], p.momentum.py());
+    put(c[PARTICLE_PZ], p.momentum.pz());
+    put(c[PARTICLE_E], p.momentum.e());
+  }
+  for (const auto& v : data_.vertices) {
+    put<std::int32_t>(c[VERTEX_STATUS], v.status);
+    put(c[VERTEX_X], v.position.x());
+    put(c[VERTEX_Y], v.position.y());
+    put(c[VERTEX_Z], v.position.z());
+    put(c[VERTEX_T], v.position.t());
+  }
+  for (const auto& w : data_.weights) put(c[WEIGHTS], w);
+  for (const auto& l : data_.links1) put<std::int32_t>(c[LINKS1], l);
+  for (const auto& l : data_.links2) put<std::int32_t>(c[LINKS2], l);
+  for (std::size_t i = 0; i < data_.attribute_id.size(); ++i) {
+    const auto& name = data_.attribute_name[i];
+    const auto& str = data_.attribute_string[i];
+    put<std::int32_t>(c[ATTRIBUTE_ID], data_.attribute_id[i]);
+    put<std::int64_t>(c[ATTRIBUTE_NAME_SIZE], name.size());
+    put<std::int64_t>(c[ATTRIBUTE_STRING_SIZE], str.size());
+    c[ATTRIBUTE_NAME].insert(c[ATTRIBUTE_NAME].end(), name.begin(), name.end());
+    c[ATTRIBUTE_STRING].insert(c[ATTRIBUTE_STRING].end(), str.begin(), str.end());
+  }
+
+  ++nevents_;
+  if (++batch_events_ == static_cast<std::uint64_t>(batch_size_)) write_batch();
+}
+
+void WriterColumnar::write_batch() {
+  if (batch_events_ == 0) return;
+  index_.push_back(bytes_);
+  index_.push_back(nevents_ - batch_events_);
+  index_.push_back(batch_events_);
+  const std::uint8_t tag = 'B';
+  write(&tag, 1);
+  write(&batch_events_, 8);
+  std::vector<char> stored;
+  for (int i = 0; i < NCOLUMNS; ++i) {
+    auto& raw = columns_[i];
+    const std::uint8_t flags = encode(raw, itemsize(schema[i].dtype), compression_, stored);
+    const std::uint64_t raw_size = raw.size(), stored_size = stored.size();
+    write(&flags, 1);
+    write(&raw_size, 8);
+    write(&stored_size, 8);
+    write(stored.data(), stored.size());
+    raw.clear();
+  }
+  batch_events_ = 0;
+}
+
+bool WriterColumnar::failed() { return stream_->fail(); }
+
+void WriterColumnar::close() {
+  if (closed_) return;
+  closed_ = true;
+  if (!header_written_) write_header();
+  write_batch();
+  const std::uint64_t footer = bytes_;
+  const std::uint8_t tag = 'I';
+  const std::uint64_t nbatches = index_.size() / 3;
+  write(&tag, 1);
+  write(&nbatches, 8);
+  write(index_.data(), index_.size() * 8);
+  write(&footer, 8);
+  write(magic, sizeof(magic));
+  stream_->flush();
+  if (file_) file_->close();
+}
+
+ReaderColumnar::ReaderColumnar(const std::string& filename)
+    : file_(new std::ifstream(filename, std::ios::binary)), stream_(file_.get()) {
+  if (!*file_) throw std::runtime_error("cannot open file " + filename);
+  read_header();
+  read_index();
+}
+
+ReaderColumnar::ReaderColumnar(std::istream& stream) : stream_(&stream) {
+  read_header();
+  read_index();
+}
+
+void ReaderColumnar::read(void* p, std::size_t n) {
+  stream_->read(static_cast<char*>(p), n);
+  if (static_cast<std::size_t>(stream_->gcount()) != n) corrupt();
+}
+
+void ReaderColumnar::read_header() {
+  char m[8];
+  std::uint32_t v = 0, bom = 0, ncolumns = 0;
+  read(m, 8);
+  if (std::memcmp(m, magic, 8) != 0)
+    throw std::runtime_error("not a pyhepmc columnar file");
+  read(&v, 4);
+  if (v != version)
+    throw std::runtime_error("unsupported columnar format version " + std::to_string(v));
+  read(&bom, 4);
+  if (bom != byte_order_mark)
+    throw std::runtime_error("columnar file was written with a different byte order");
+  read(&ncolumns, 4);
+  if (ncolumns != NCOLUMNS) corrupt();
+  for (const auto& spec : schema) {
+    std::uint16_t n = 0;
+    std::uint8_t dtype = 0;
+    read(&n, 2);
+    std::string name(n, '\0');
+    read(&name[0], n);
+    read(&dtype, 1);
+    if (name != spec.name || dtype != spec.dtype)
+      throw std::runtime_error("unexpected column " + name + " in columnar file");
+  }
+
+  std::uint8_t has_run_info = 0;
+  read(&has_run_info, 1);
+  if (!has_run_info) return;
+  GenRunInfoData data;
+  for (auto* list : {&data.weight_names, &data.tool_name, &data.tool_version,
+                     &data.tool_description, &data.attribute_name,
+                     &data.attribute_string}) {
+    std::uint32_t n = 0;
+    read(&n, 4);
+    list->resize(n);
+    for (auto& s : *list) {
+      std::uint32_t size = 0;
+      read(&size, 4);
+      s.resize(size);
+      if (size) read(&s[0], size);
+    }
+  }
+  auto run = std::make_shared<GenRunInfo>();
+  run->read_data(data);
+  set_run_info(run);
+}
+
+void ReaderColumnar::read_index() {
+  // the index is optional, streams which cannot seek are read sequentially
+  const auto data_begin = stream_->tellg();
+  if (data_begin < 0) {
+    stream_->clear();
+    return;
+  }
+  try {
+    stream_->seekg(-16, std::ios::end);
+    std::uint64_t footer = 0;
+    char m[8];
+    read(&footer, 8);
+    read(m, 8);
+    if (std::memcmp(m, magic, 8) == 0) {
+      stream_->seekg(footer);
+      std::uint8_t tag = 0;
+      std::uint64_t nbatches = 0;
+      read(&tag, 1);
+      read(&nbatches, 8);
+      if (tag != 'I') corrupt();
+      index_.resize(3 * nbatches);
+      read(index_.data(), index_.size() * 8);
+      batch_first_.resize(nbatches);
+      for (std::uint64_t b = 0; b < nbatches; ++b) batch_first_[b] = index_[3 * b + 1];
+      has_index_ = true;
+    }
+  } catch (std::runtime_error&) {
+    // file was not closed properly, we can still read it sequentially
+    index_.clear();
+    batch_first_.clear();
+    has_index_ = false;
+  }
+  stream_->clear();
+  stream_->seekg(data_begin);
+}
+
+bool ReaderColumnar::read_batch() {
+  const auto tag = stream_->get();
+  if (tag == std::char_traits<char>::eof() || tag == 'I') return false;
+  if (tag != 'B') corrupt();
+  batch_begin_ += batch_events_;
+  std::uint64_t n = 0;
+  read(&n, 8);
+
+  columns_.resize(NCOLUMNS);
+  std::vector<char> stored;
+  for (int i = 0; i < NCOLUMNS; ++i) {
+    std::uint8_t flags = 0;
+    std::uint64_t raw_size = 0, stored_size = 0;
+    read(&flags, 1);
+    read(&raw_size, 8);
+    read(&stored_size, 8);
+    stored.resize(stored_size);
+    read(stored.data(), stored_size);
+    columns_[i].resize(raw_size);
+    decode(flags, stored, itemsize(schema[i].dtype), columns_[i]);
+    if (columns_[i].size() != raw_size || raw_size % itemsize(schema[i].dtype) != 0)
+      corrupt();
+  }
+
+  // check the column sizes, so that building the events cannot read out of bounds
+  auto size = [this](int i) {
+    return columns_[i].size() / itemsize(schema[i].dtype);
+  };
+  for (int i = EVENT_NUMBER; i <= N_ATTRIBUTES; ++i)
+    if (size(i) != (i == EVENT_POS ? 4 : 1) * n) corrupt();
+  auto prefix_sum = [this](std::vector<std::uint64_t>& offsets, int i) {
+    const auto* counts = get<std::int64_t>(columns_, i);
+    const auto n = columns_[i].size() / 8;
+    offsets.assign(1, 0);
+    for (std::size_t k = 0; k < n; ++k) {
+      if (counts[k] < 0) corrupt();
+      offsets.push_back(offsets.back() + counts[k]);
+    }
+  };
+  prefix_sum(offsets_[O_PARTICLES], N_PARTICLES);
+  prefix_sum(offsets_[O_VERTICES], N_VERTICES);
+  prefix_sum(offsets_[O_WEIGHTS], N_WEIGHTS);
+  prefix_sum(offsets_[O_LINKS], N_LINKS);
+  prefix_sum(offsets_[O_ATTRIBUTES], N_ATTRIBUTES);
+  prefix_sum(offsets_[O_ATTRIBUTE_NAME], ATTRIBUTE_NAME_SIZE);
+  prefix_sum(offsets_[O_ATTRIBUTE_STRING], ATTRIBUTE_STRING_SIZE);
+  for (int i = PARTICLE_PID; i <= PARTICLE_E; ++i)
+    if (size(i) != offsets_[O_PARTICLES].back()) corrupt();
+  for (int i = VERTEX_STATUS; i <= VERTEX_T; ++i)
+    if (size(i) != offsets_[O_VERTICES].back()) corrupt();
+  if (size(WEIGHTS) != offsets_[O_WEIGHTS].back()) corrupt();
+  if (size(LINKS1) != offsets_[O_LINKS].back()) corrupt();
+  if (size(LINKS2) != offsets_[O_LINKS].back()) corrupt();
+  for (int i = ATTRIBUTE_ID; i <= ATTRIBUTE_STRING_SIZE; ++i)
+    if (size(i) != offsets_[O_ATTRIBUTES].back()) corrupt();
+  if (size(ATTRIBUTE_NAME) != offsets_[O_ATTRIBUTE_NAME].back()) corrupt();
+  if (size(ATTRIBUTE_STRING) != offsets_[O_ATTRIBUTE_STRING].back()) corrupt();
+
+  batch_events_ = n;
+  next_ = 0;
+  if (has_index_) batch_end_ = stream_->tellg();
+  return true;
+}
+
+bool ReaderColumnar::read_event(GenEvent& event) {
+  if (failed_) return false;
+  while (next_ == batch_events_) {
+    if (!read_batch()) {
+      failed_ = true;
+      return false;
+    }
+  }
+  const auto k = next_++;
+  const auto& c = columns_;
+
+  GenEventData data;
+  data.event_number = get<std::int32_t>(c, EVENT_NUMBER)[k];
+  data.momentum_unit =
+      static_cast<Units::MomentumUnit>(get<std::int32_t>(c, MOMENTUM_UNIT)[k]);
+  data.length_unit = static_cast<Units::LengthUnit>(get<std::int32_t>(c, LENGTH_UNIT)[k]);
+  const auto* pos = get<double>(c, EVENT_POS) + 4 * k;
+  data.event_pos = FourVector(pos[0], pos[1], pos[2], pos[3]);
+
+  const auto pb = offsets_[O_PARTICLES][k], pe = offsets_[O_PARTICLES][k + 1];
+  data.particles.resize(pe - pb);
+  for (auto i = pb; i < pe; ++i) {
+    auto& p = data.particles[i - pb];
+    p.pid = get<std::int32_t>(c, PARTICLE_PID)[i];
+    p.status = get<std::int32_t>(c, PARTICLE_STATUS)[i];
+    p.is_mass_set = get<std::uint8_t>(c, PARTICLE_IS_MASS_SET)[i] != 0;
+    p.mass = get<double>(c, PARTICLE_MASS)[i];
+    p.momentum = FourVector(get<double>(c, PARTICLE_PX)[i], get<double>(c, PARTICLE_PY)[i],
+                            get<double>(c, PARTICLE_PZ)[i], get<double>(c, PARTICLE_E)[i]);
+  }
+
+  const auto vb = offsets_[O_VERTICES][k], ve = offsets_[O_VERTICES][k + 1];
+  data.vertices.resize(ve - vb);
+  for (auto i = vb; i < ve; ++i) {
+    auto& v = data.vertices[i - vb];
+    v.status = get<std::int32_t>(c, VERTEX_STATUS)[i];
+    v.position = FourVector(get<double>(c, VERTEX_X)[i], get<double>(c, VERTEX_Y)[i],
+                            get<double>(c, VERTEX_Z)[i], get<double>(c, VERTEX_T)[i]);
+  }
+
+  const auto* w = get<double>(c, WEIGHTS);
+  data.weights.assign(w + offsets_[O_WEIGHTS][k], w + offsets_[O_WEIGHTS][k + 1]);
+  const auto lb = offsets_[O_LINKS][k], le = offsets_[O_LINKS][k + 1];
+  data.links1.assign(get<std::int32_t>(c, LINKS1) + lb, get<std::int32_t>(c, LINKS1) + le);
+  data.links2.assign(get<std::int32_t>(c, LINKS2) + lb, get<std::int32_t>(c, LINKS2) + le);
+
+  const auto ab = offsets_[O_ATTRIBUTES][k], ae = offsets_[O_ATTRIBUTES][k + 1];
+  data.attribute_id.assign(get<std::int32_t>(c, ATTRIBUTE_ID) + ab,
+                           get<std::int32_t>(c, ATTRIBUTE_ID) + ae);
+  for (auto i = ab; i < ae; ++i) {
+    const auto& on = offsets_[O_ATTRIBUTE_NAME];
+    const auto& os = offsets_[O_ATTRIBUTE_STRING];
+    data.attribute_name.emplace_back(c[ATTRIBUTE_NAME].data() + on[i], on[i + 1] - on[i]);
+    data.attribute_string.emplace_back(c[ATTRIBUTE_STRING].data() + os[i],
+                                       os[i + 1] - os[i]);
+  }
+
+  event.read_data(data);
+  event.set_run_info(run_info());
+  return true;
+}
+
+bool ReaderColumnar::failed() { return failed_; }
+
+void ReaderColumnar::close() {
+  failed_ = true;
+  columns_.clear();
+  if (file_) file_->close();
+}
+
+std::uint64_t ReaderColumnar::num_events() const {
+  if (!has_index_) throw std::runtime_error("columnar file has no index");
+  if (index_.empty()) return 0;
+  return index_[index_.size() - 2] + index_.back();
+}
+
+void ReaderColumnar::seek_event(std::uint64_t i) {
+  if (i >= num_events()) throw std::out_of_range("event index out of range");
+  // batches are sorted by first event, find the one that contains event i
+  const auto it = std::upper_bound(batch_first_.begin(), batch_first_.end(), i);
+  const std::size_t b = it - batch_first_.begin() - 1;
+  const auto first = batch_first_[b];
+  stream_->clear();
+  if (first != batch_begin_ || batch_events_ == 0) {
+    stream_->seekg(index_[3 * b]);
+    batch_begin_ = first;
+    batch_events_ = 0;
+    if (!read_batch()) corrupt();
+  } else {
+    // the batch is still loaded, but the stream may have moved past it, for
+    // example to the footer after the last event was read
+    stream_->seekg(batch_end_);
+  }
+  next_ = i - first;
+  failed_ = false;
+}
+
+} // namespace HepMC3
@@ -0,0 +1,103 @@
+#ifndef PYHEPMC_COLUMNAR_HPP
+#define PYHEPMC_COLUMNAR_HPP
+
+#include "pointer.hpp"
+#include <HepMC3/Data/GenEventData.h>
+#include <HepMC3/Reader.h>
+#include <HepMC3/Writer.h>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Binary columnar container format for HepMC3 events ("pyhepmc columnar").
+//
+// Layout (native little-endian byte order):
+//
+//   header:  magic "PYHEPMCC", uint32 version, uint32 byte order mark,
+//            schema (uint32 number of columns, per column: uint16 name length,
+//            name, uint8 type), run info block
+//   batches: uint8 'B', uint64 number of events,
+//            per column: uint8 codec, uint64 raw size, uint64 stored size, data
+//   footer:  uint8 'I', uint64 number of batches,
+//            per batch: uint64 file offset, uint64 first event, uint64 events,
+//            uint64 offset of footer, magic "PYHEPMCC"
+//
+// A batch stores the GenEventData of several events. Each field is a separate
+// column, so that similar values are compressed together. Variable-length
+// fields are stored with an additional column of counts per event. The footer
+// allows random access, but files can also be read sequentially without it.
+namespace HepMC3 {
+
+namespace columnar {
+using column_list = std::vector<std::vector<char>>;
+}
+
+class WriterColumnar : public Writer {
+  std::unique_ptr<std::ofstream> file_;
+  std::ostream* stream_;
+  int batch_size_;
+  int compression_;
+  bool header_written_ = false;
+  bool closed_ = false;
+  std::uint64_t bytes_ = 0;
+  std::uint64_t nevents_ = 0;
+  std::uint64_t batch_events_ = 0;
+  columnar::column_list columns_;
+  std::vector<std::uint64_t> index_;
+  GenEventData data_;
+
+  void write(const void* p, std::size_t n);
+  void write_header();
+  void write_batch();
+
+public:
+  WriterColumnar(const std::string& filename, GenRunInfoPtr run, int batch_size,
+                 int compression);
+  WriterColumnar(std::ostream& stream, GenRunInfoPtr run, int batch_size,
+                 int compression);
+  ~WriterColumnar();
+
+  void write_event(const GenEvent& event) override;
+  bool failed() override;
+  void close() override;
+};
+
+class ReaderColumnar : public Reader {
+  std::unique_ptr<std::ifstream> file_;
+  std::istream* stream_;
+  bool failed_ = false;
+  bool has_index_ = false;
+  std::vector<std::uint64_t> index_; // triplets of offset, first event, events
+  std::vector<std::uint64_t> batch_first_; // first event of each batch
+  columnar::column_list columns_;
+  std::uint64_t batch_begin_ = 0; // event number of the first event in batch
+  std::uint64_t batch_events_ = 0;
+  std::uint64_t next_ = 0; // event in batch which is read next
+  std::streamoff batch_end_ = 0; // stream offset after the batch, requires the index
+  std::vector<std::uint64_t> offsets_[7];
+
+  void read(void* p, std::size_t n);
+  void read_header();
+  void read_index();
+  bool read_batch();
+
+public:
+  ReaderColumnar(const std::string& filename);
+  ReaderColumnar(std::istream& stream);
+
+  bool read_event(GenEvent& event) override;
+  bool failed() override;
+  void close() override;
+
+  // number of events in the file, requires the index in the footer
+  std::uint64_t num_events() const;
+  // position reader so that event i is read next, requires the index
+  void seek_event(std::uint64_t i);
+};
+
+} // namespace HepMC3
+
+#endif
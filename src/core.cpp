@@ -8,6 +8,7 @@
 #include "repr.hpp"
 #include <HepMC3/Attribute.h>
 #include <HepMC3/Data/GenEventData.h>
+#include <HepMC3/Data/GenRunInfoData.h>
 #include <HepMC3/FourVector.h>
 #include <HepMC3/GenCrossSection.h>
 #include <HepMC3/GenEvent.h>
@@ -21,6 +22,7 @@
 #include <HepMC3/Units.h>
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -36,6 +38,7 @@
 
 void register_io(py::module& m);
 void register_bench(py::module& m);
+void register_selection(py::module& m);
 
 namespace HepMC3 {
 
@@ -65,6 +68,21 @@ void from_hepevt(GenEvent& event, int event_number, py::array_t<double> px,
                  py::object parents, py::object children, py::object vx, py::object vy,
                  py::object vz, py::object vt, bool fortran);
 
+py::object from_hepevt_batch(py::array_t<std::int64_t> offsets, py::object px,
+                             py::object py, py::object pz, py::object en, py::object m,
+                             py::object pid, py::object status, py::object parents,
+                             py::object children, py::object vx, py::object vy,
+                             py::object vz, py::object vt, py::object event_number,
+                             bool fortran, int threads, py::object writer);
+
+py::dict to_hepevt(const GenEvent& event, bool fortran);
+
+py::dict to_hepevt_batch(py::iterable events, bool fortran, int threads);
+
+py::object diff(const GenEvent& a, const GenEvent& b, double tolerance);
+
+py::list diff_batch(py::iterable a, py::iterable b, double tolerance, int threads);
+
 } // namespace HepMC3
 
 PYBIND11_MODULE(_core, m) {
@@ -216,14 +234,14 @@ PYBIND11_MODULE(_core, m) {
   py::class_<GenEventData>(m, "GenEventData", DOC(GenEventData))
       .def(py::init<>())
       // clang-format off
-      PROP_RO2(weights, GenEventData)
-      PROP_RO2(vertices, GenEventData)
-      PROP_RO2(particles, GenEventData)
-      PROP_RO2(links1, GenEventData)
-      PROP_RO2(links2, GenEventData)
-      PROP_RO2(attribute_id, GenEventData)
-      PROP_RO2(attribute_name, GenEventData)
-      PROP_RO2(attribute_string, GenEventData)
+      PROP3(weights, GenEventData)
+      PROP3(vertices, GenEventData)
+      PROP3(particles, GenEventData)
+      PROP3(links1, GenEventData)
+      PROP3(links2, GenEventData)
+      PROP3(attribute_id, GenEventData)
+      PROP3(attribute_name, GenEventData)
+      PROP3(attribute_string, GenEventData)
       ATTR(event_number, GenEventData)
       ATTR(momentum_unit, GenEventData)
       ATTR(length_unit, GenEventData)
@@ -427,6 +445,29 @@ PYBIND11_MODULE(_core, m) {
             }
           },
           DOC(attributes))
+      // GenRunInfoData is pickled as a tuple of string lists
+      .def(py::pickle(
+          [](const GenRunInfo& self) {
+            GenRunInfoData d;
+            self.write_data(d);
+            return py::make_tuple(d.weight_names, d.tool_name, d.tool_version,
+                                  d.tool_description, d.attribute_name,
+                                  d.attribute_string);
+          },
+          [](py::tuple t) {
+            using strings = std::vector<std::string>;
+            if (t.size() != 6) throw py::value_error("invalid state");
+            GenRunInfoData d;
+            d.weight_names = py::cast<strings>(t[0]);
+            d.tool_name = py::cast<strings>(t[1]);
+            d.tool_version = py::cast<strings>(t[2]);
+            d.tool_description = py::cast<strings>(t[3]);
+            d.attribute_name = py::cast<strings>(t[4]);
+            d.attribute_string = py::cast<strings>(t[5]);
+            auto run = std::make_shared<GenRunInfo>();
+            run->read_data(d);
+            return run;
+          }))
       // clang-format off
       EQ(GenRunInfo)
       REPR(GenRunInfo)
@@ -508,6 +549,7 @@ PYBIND11_MODULE(_core, m) {
             }
           },
           DOC(attributes))
+      .def("all_attributes", all_attributes, DOC(GenEvent.all_attributes))
       .def("reserve", &GenEvent::reserve, "particles"_a, "vertices"_a = 0,
            DOC(GenEvent.reserve))
       .def("__str__",
@@ -521,6 +563,7 @@ PYBIND11_MODULE(_core, m) {
            "children"_a = py::none(), "vx"_a = py::none(), "vy"_a = py::none(),
            "vz"_a = py::none(), "vt"_a = py::none(), "fortran"_a = true,
            DOC(GenEvent.from_hepevt))
+      .def("to_hepevt", to_hepevt, "fortran"_a = true, DOC(GenEvent.to_hepevt))
       .def("write_data", &GenEvent::write_data, "data"_a, DOC(GenEvent.write_data))
       .def("read_data", &GenEvent::read_data, "data"_a, DOC(GenEvent.read_data))
       .def_property_readonly("numpy", [](py::object self) { return NumpyAPI(self); })
@@ -652,10 +695,23 @@ PYBIND11_MODULE(_core, m) {
 
   m.def("_Setup_set_debug_level", &Setup::set_debug_level, DOC(Setup.set_debug_level));
 
+  m.def("_from_hepevt_batch", from_hepevt_batch, "offsets"_a, "px"_a, "py"_a, "pz"_a,
+        "en"_a, "m"_a, "pid"_a, "status"_a, "parents"_a = py::none(),
+        "children"_a = py::none(), "vx"_a = py::none(), "vy"_a = py::none(),
+        "vz"_a = py::none(), "vt"_a = py::none(), "event_number"_a = py::none(),
+        "fortran"_a = true, "threads"_a = 0, "writer"_a = py::none());
+
+  m.def("_to_hepevt_batch", to_hepevt_batch, "events"_a, "fortran"_a = true,
+        "threads"_a = 0);
+
   FUNC(equal_particle_sets);
   FUNC(equal_vertex_sets);
 
+  m.def("_diff", diff, "a"_a, "b"_a, "tolerance"_a);
+  m.def("_diff_batch", diff_batch, "a"_a, "b"_a, "tolerance"_a, "threads"_a = 0);
+
   register_io(m);
   register_bench(m);
   register_numpy_api(m);
+  register_selection(m);
 }
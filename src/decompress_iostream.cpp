@@ -0,0 +1,191 @@
+#include "decompress_iostream.hpp"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef PYHEPMC_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef PYHEPMC_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+bool ends_with(const std::string& s, const std::string& suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+class file_decoder : public decoder {
+protected:
+  std::ifstream file_;
+  std::vector<char> in_;
+
+  file_decoder(const std::string& filename, int size)
+      : file_(filename, std::ios::binary), in_(size) {
+    if (!file_) throw std::runtime_error("cannot open file " + filename);
+  }
+
+  // read next chunk of compressed input, returns 0 at end of file
+  std::size_t refill() {
+    file_.read(in_.data(), in_.size());
+    return file_.gcount();
+  }
+
+  // same message as Python's gzip module
+  [[noreturn]] static void truncated() {
+    throw std::runtime_error(
+        "compressed file ended before the end-of-stream marker was reached");
+  }
+};
+
+#ifdef PYHEPMC_HAS_ZLIB
+class gzip_decoder : public file_decoder {
+  z_stream zs_{};
+  bool eof_ = false;
+  bool stream_end_ = true; // no member was started or the last one is complete
+
+public:
+  gzip_decoder(const std::string& filename, int size) : file_decoder(filename, size) {
+    // 15 + 32: maximum window size, auto-detect gzip or zlib header
+    if (inflateInit2(&zs_, 15 + 32) != Z_OK)
+      throw std::runtime_error("zlib initialization failed");
+  }
+
+  ~gzip_decoder() { inflateEnd(&zs_); }
+
+  std::size_t read(char* out, std::size_t n) override {
+    zs_.next_out = reinterpret_cast<Bytef*>(out);
+    zs_.avail_out = static_cast<uInt>(n);
+    while (zs_.avail_out == n) {
+      if (zs_.avail_in == 0 && !eof_) {
+        zs_.avail_in = static_cast<uInt>(refill());
+        zs_.next_in = reinterpret_cast<Bytef*>(in_.data());
+        eof_ = zs_.avail_in == 0;
+      }
+      if (eof_ && stream_end_) break;
+      // at end of file, this still flushes output which inflate holds back
+      const int ret = inflate(&zs_, Z_NO_FLUSH);
+      if (ret == Z_STREAM_END) {
+        // gzip files may consist of several concatenated members
+        inflateReset(&zs_);
+        stream_end_ = true;
+      } else if (ret == Z_OK) {
+        stream_end_ = false;
+      } else if (ret == Z_BUF_ERROR) {
+        // no progress possible, because the input is exhausted
+        if (eof_) truncated();
+      } else {
+        throw std::runtime_error(std::string("zlib error: ") +
+                                 (zs_.msg ? zs_.msg : "unknown"));
+      }
+    }
+    return n - zs_.avail_out;
+  }
+};
+#endif
+
+#ifdef PYHEPMC_HAS_ZSTD
+class zstd_decoder : public file_decoder {
+  ZSTD_DCtx* ctx_;
+  ZSTD_inBuffer input_{nullptr, 0, 0};
+  bool eof_ = false;
+  // last result of ZSTD_decompressStream, 0 if the frame is complete
+  std::size_t last_ = 0;
+
+public:
+  zstd_decoder(const std::string& filename, int size)
+      : file_decoder(filename, size), ctx_(ZSTD_createDCtx()) {
+    if (!ctx_) throw std::runtime_error("zstd initialization failed");
+  }
+
+  ~zstd_decoder() { ZSTD_freeDCtx(ctx_); }
+
+  std::size_t read(char* out, std::size_t n) override {
+    ZSTD_outBuffer output{out, n, 0};
+    while (output.pos == 0) {
+      if (input_.pos == input_.size && !eof_) {
+        input_ = {in_.data(), refill(), 0};
+        eof_ = input_.size == 0;
+      }
+      if (eof_ && last_ == 0) break;
+      // at end of file, this still flushes output which zstd holds back
+      last_ = ZSTD_decompressStream(ctx_, &output, &input_);
+      if (ZSTD_isError(last_))
+        throw std::runtime_error(std::string("zstd error: ") +
+                                 ZSTD_getErrorName(last_));
+      if (eof_ && output.pos == 0 && last_ != 0) truncated();
+    }
+    return output.pos;
+  }
+};
+#endif
+
+} // namespace
+
+decompress_streambuf::decompress_streambuf(const std::string& filename, int size)
+    : buffer_(size) {
+#ifdef PYHEPMC_HAS_ZLIB
+  if (ends_with(filename, ".gz")) decoder_.reset(new gzip_decoder(filename, size));
+#endif
+#ifdef PYHEPMC_HAS_ZSTD
+  if (ends_with(filename, ".zst") || ends_with(filename, ".zstd"))
+    decoder_.reset(new zstd_decoder(filename, size));
+#endif
+  if (!decoder_) throw std::runtime_error("no native decoder for file " + filename);
+  end_ = buffer_.data();
+  setg(end_, end_, end_);
+}
+
+decompress_streambuf::int_type decompress_streambuf::underflow() {
+  if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+  char* start = egptr();
+  for (;;) {
+    if (start == end_) {
+      const auto n = decoder_->read(buffer_.data(), buffer_.size());
+      if (n == 0) return traits_type::eof();
+      start = buffer_.data();
+      end_ = start + n;
+    }
+    if (!skip_next_) break;
+    skip_next_ = false;
+    if (*start == '\n') ++start;
+  }
+  char* stop = end_;
+  auto cr = static_cast<char*>(std::memchr(start, '\r', stop - start));
+  if (cr) {
+    // turn \r into \n and end the view there, the next \n is skipped
+    *cr = '\n';
+    stop = cr + 1;
+    skip_next_ = true;
+  }
+  setg(buffer_.data(), start, stop);
+  return traits_type::to_int_type(*gptr());
+}
+
+std::vector<std::string> decompress_streambuf::suffixes() {
+  std::vector<std::string> result;
+#ifdef PYHEPMC_HAS_ZLIB
+  result.push_back(".gz");
+#endif
+#ifdef PYHEPMC_HAS_ZSTD
+  result.push_back(".zst");
+  result.push_back(".zstd");
+#endif
+  return result;
+}
+
+decompress_iostream::decompress_iostream(const std::string& filename, int size)
+    : std::iostream(new decompress_streambuf(filename, size)) {
+  // let decompression errors from underflow reach the caller, otherwise the
+  // stream only sets badbit and the readers treat it like the end of the file
+  exceptions(std::ios::badbit);
+}
+
+decompress_iostream::~decompress_iostream() {
+  // rdbuf(nullptr) sets badbit, which must not throw here
+  exceptions(std::ios::goodbit);
+  delete rdbuf(nullptr);
+}
@@ -0,0 +1,45 @@
+#ifndef PYHEPMC_DECOMPRESS_IOSTREAM_HPP
+#define PYHEPMC_DECOMPRESS_IOSTREAM_HPP
+
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Interface for the decompression backends, each reads compressed data
+// from a file and produces decompressed bytes.
+struct decoder {
+  virtual ~decoder() {}
+  // returns number of bytes written to out, 0 signals end of file;
+  // throws if the file ends in the middle of a compressed stream
+  virtual std::size_t read(char* out, std::size_t n) = 0;
+};
+
+// Decompresses a file in C++, without calling into Python. This allows the
+// Readers to run without the GIL, since no Python file object is involved.
+//
+// Like pystreambuf and mmap_streambuf, \r is turned into \n and the following
+// \n is skipped, since HepMC3 expects \n as line terminator.
+class decompress_streambuf : public std::streambuf {
+  std::unique_ptr<decoder> decoder_;
+  std::vector<char> buffer_;
+  char* end_ = nullptr; // end of the decompressed data in buffer_
+  bool skip_next_ = false;
+
+public:
+  decompress_streambuf(const std::string& filename, int size);
+
+  int_type underflow() override;
+
+  // file name suffixes for which a decoder is compiled in
+  static std::vector<std::string> suffixes();
+};
+
+class decompress_iostream : public std::iostream {
+public:
+  decompress_iostream(const std::string& filename, int size);
+  ~decompress_iostream();
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "equal.hpp"
+#include "numpy_api.hpp"
+#include "parallel.hpp"
+#include "pybind.hpp"
+#include <HepMC3/Attribute.h>
+#include <HepMC3/GenEvent.h>
+#include <HepMC3/GenParticle.h>
+#include <HepMC3/GenVertex.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace HepMC3 {
+
+namespace {
+
+// Differences between two events. Particles and vertices are given by their index
+// in GenEvent.particles and GenEvent.vertices.
+struct event_diff {
+  std::vector<std::string> header;
+  std::vector<int> particles_a, particles_b;
+  std::vector<int> vertices_a, vertices_b;
+  std::vector<std::string> attributes;
+
+  bool empty() const {
+    return header.empty() && particles_a.empty() && particles_b.empty() &&
+           vertices_a.empty() && vertices_b.empty() && attributes.empty();
+  }
+};
+
+bool equal_weights(const std::vector<double>& a, const std::vector<double>& b,
+                   double tol) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [tol](double x, double y) { return std::abs(x - y) < tol; });
+}
+
+// Names of the attributes which differ in their ids or string values. Attributes
+// are compared by their string representation, like GenRunInfo attributes.
+std::vector<std::string> attribute_diff(const GenEvent& a, const GenEvent& b) {
+  const auto amap = a.attributes();
+  const auto bmap = b.attributes();
+  auto equal = [](const std::map<int, AttributePtr>& x,
+                  const std::map<int, AttributePtr>& y) {
+    return std::equal(x.begin(), x.end(), y.begin(), y.end(),
+                      [](const std::pair<const int, AttributePtr>& u,
+                         const std::pair<const int, AttributePtr>& v) {
+                        if (u.first != v.first) return false;
+                        std::string su, sv;
+                        if (u.second) u.second->to_string(su);
+                        if (v.second) v.second->to_string(sv);
+                        return su == sv;
+                      });
+  };
+  // both maps are sorted by name, so the result is sorted too
+  std::vector<std::string> result;
+  auto ia = amap.begin();
+  auto ib = bmap.begin();
+  while (ia != amap.end() || ib != bmap.end()) {
+    if (ib == bmap.end() || (ia != amap.end() && ia->first < ib->first)) {
+      result.push_back(ia++->first);
+    } else if (ia == amap.end() || ib->first < ia->first) {
+      result.push_back(ib++->first);
+    } else {
+      if (!equal(ia->second, ib->second)) result.push_back(ia->first);
+      ++ia;
+      ++ib;
+    }
+  }
+  return result;
+}
+
+event_diff diff_events(const GenEvent& a, const GenEvent& b, double tol) {
+  event_diff d;
+  if (a.event_number() != b.event_number()) d.header.push_back("event_number");
+  if (a.momentum_unit() != b.momentum_unit()) d.header.push_back("momentum_unit");
+  if (a.length_unit() != b.length_unit()) d.header.push_back("length_unit");
+  if (!equal_weights(a.weights(), b.weights(), tol)) d.header.push_back("weights");
+  if (!is_close(a.event_pos(), b.event_pos(), tol)) d.header.push_back("event_pos");
+  if (!equal_run_info(a, b)) d.header.push_back("run_info");
+  match_particles(a.particles(), b.particles(), tol, &d.particles_a, &d.particles_b);
+  match_vertices(a.vertices(), b.vertices(), tol, &d.vertices_a, &d.vertices_b);
+  d.attributes = attribute_diff(a, b);
+  return d;
+}
+
+py::object to_python(const event_diff& d) {
+  if (d.empty()) return py::none();
+  auto array = [](const std::vector<int>& v) {
+    py::array_t<int> a(v.size());
+    std::copy(v.begin(), v.end(), a.mutable_data());
+    return a;
+  };
+  py::dict result;
+  result["header"] = py::cast(d.header);
+  result["particles_a"] = array(d.particles_a);
+  result["particles_b"] = array(d.particles_b);
+  result["vertices_a"] = array(d.vertices_a);
+  result["vertices_b"] = array(d.vertices_b);
+  result["attributes"] = py::cast(d.attributes);
+  return std::move(result);
+}
+
+} // namespace
+
+// Returns None if the events are equal, otherwise a dict with the differences.
+py::object diff(const GenEvent& a, const GenEvent& b, double tolerance) {
+  event_diff d;
+  {
+    py::gil_scoped_release release;
+    d = diff_events(a, b, tolerance);
+  }
+  return to_python(d);
+}
+
+// Compares the events pairwise in parallel, returns a list with the results of
+// diff for the first min(len(a), len(b)) pairs.
+py::list diff_batch(py::iterable a, py::iterable b, double tolerance, int threads) {
+  std::vector<py::object> objects_a, objects_b;
+  const auto pa = collect_events(a, objects_a);
+  const auto pb = collect_events(b, objects_b);
+  const int n = std::min(pa.size(), pb.size());
+  std::vector<event_diff> diffs(n);
+  {
+    py::gil_scoped_release release;
+    parallel_for(n, threads,
+                 [&](int i) { diffs[i] = diff_events(*pa[i], *pb[i], tolerance); });
+  }
+  py::list result;
+  for (const auto& d : diffs) result.append(to_python(d));
+  return result;
+}
+
+} // namespace HepMC3
@@ -1,5 +1,6 @@
 #include "HepMC3/GenPdfInfo.h"
 #include "HepMC3/LHEFAttributes.h"
+#include "equal.hpp"
 #include "pointer.hpp"
 #include <HepMC3/Data/GenEventData.h>
 #include <HepMC3/Data/GenParticleData.h>
@@ -9,7 +10,13 @@
 #include <HepMC3/GenParticle.h>
 #include <HepMC3/GenRunInfo.h>
 #include <HepMC3/GenVertex.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace HepMC3 {
 
@@ -33,54 +40,180 @@ bool operator==(const std::vector<T>& a, const std::vector<T>& b) {
   return std::equal(a.begin(), a.end(), b.begin(), b.end());
 }
 
-// equality comparions used by unit tests
-bool is_close(const FourVector& a, const FourVector& b, double rel_eps = 1e-7) {
-  auto is_close = [rel_eps](double a, double b) { return std::abs(a - b) < rel_eps; };
+namespace {
+
+// Finds a one-to-one mapping between the elements of a and b, so that mapped
+// elements are equal according to eq. Equal elements must have the same key and
+// values of time which differ by less than width. Instead of comparing each
+// element of a with all elements of b, b is sorted by (key, time) and the
+// candidates for an element of a are found with a binary search. Matched elements
+// of b are skipped with path-compressed next pointers, so that many equal elements
+// do not lead to quadratic run time. Like a linear search, this is a greedy
+// matching, which finds the mapping unless elements are within tolerance of
+// several others.
+template <class T, class Key, class Time, class Width, class Eq>
+bool match_sets(const std::vector<T>& a, const std::vector<T>& b, Key key, Time time,
+                Width width, Eq eq, std::vector<int>* unmatched_a,
+                std::vector<int>* unmatched_b) {
+  if (!unmatched_a && a.size() != b.size()) return false;
+
+  using K = decltype(key(*b.front()));
+  struct entry {
+    K k;
+    double t;
+    int index;
+  };
+  const auto less = [](const entry& x, const entry& y) {
+    return x.k < y.k || (!(y.k < x.k) && x.t < y.t);
+  };
+  std::vector<entry> sorted;
+  sorted.reserve(b.size());
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    const double t = time(*b[i]);
+    // elements with NaN are not equal to anything
+    if (!std::isnan(t)) sorted.push_back({key(*b[i]), t, static_cast<int>(i)});
+  }
+  std::sort(sorted.begin(), sorted.end(), less);
+  const int n = sorted.size();
+
+  // next[j] == j if sorted[j] is not matched yet, otherwise it points further
+  std::vector<int> next(n + 1);
+  std::iota(next.begin(), next.end(), 0);
+  const auto find = [&next](int j) {
+    while (next[j] != j) {
+      next[j] = next[next[j]];
+      j = next[j];
+    }
+    return j;
+  };
+
+  std::vector<char> used(b.size(), 0);
+  bool all = a.size() == b.size();
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    const auto& x = *a[i];
+    const double t = time(x);
+    bool found = false;
+    if (!std::isnan(t)) {
+      const double w = width(x, t);
+      const entry lo{key(x), t - w, 0};
+      const int first = std::lower_bound(sorted.begin(), sorted.end(), lo, less) -
+                        sorted.begin();
+      for (int j = find(first); j < n; j = find(j + 1)) {
+        const entry& s = sorted[j];
+        if (lo.k < s.k || s.t - t >= w) break;
+        if (eq(x, *b[s.index])) {
+          used[s.index] = 1;
+          next[j] = j + 1;
+          found = true;
+          break;
+        }
+      }
+    }
+    if (!found) {
+      all = false;
+      if (!unmatched_a) return false;
+      unmatched_a->push_back(i);
+    }
+  }
+  if (unmatched_b) {
+    for (std::size_t i = 0; i < b.size(); ++i)
+      if (!used[i]) unmatched_b->push_back(i);
+  }
+  return all;
+}
+
+} // namespace
+
+bool is_close(const FourVector& a, const FourVector& b, double tol) {
+  auto is_close = [tol](double a, double b) { return std::abs(a - b) < tol; };
   return is_close(a.x(), b.x()) && is_close(a.y(), b.y()) && is_close(a.z(), b.z()) &&
          is_close(a.t(), b.t());
 }
 
-// compares all real qualities of two particles, but ignores the .id() field
-bool operator==(const GenParticle& a, const GenParticle& b) {
+bool equal_particles(const GenParticle& a, const GenParticle& b, double tol) {
   return a.pid() == b.pid() && a.status() == b.status() &&
-         is_close(a.momentum(), b.momentum());
+         is_close(a.momentum(), b.momentum(), tol);
+}
+
+bool match_particles(const std::vector<ConstGenParticlePtr>& a,
+                     const std::vector<ConstGenParticlePtr>& b, double tol,
+                     std::vector<int>* unmatched_a, std::vector<int>* unmatched_b) {
+  // a linear search is faster for the small sets attached to vertices
+  if (!unmatched_a && a.size() == b.size() && a.size() <= 16) {
+    unsigned used = 0;
+    for (const auto& x : a) {
+      std::size_t j = 0;
+      while (j < b.size() && ((used >> j & 1) || !equal_particles(*x, *b[j], tol))) ++j;
+      if (j == b.size()) return false;
+      used |= 1u << j;
+    }
+    return true;
+  }
+  return match_sets(
+      a, b, [](const GenParticle& x) { return std::make_pair(x.pid(), x.status()); },
+      [](const GenParticle& x) { return x.momentum().e(); },
+      [tol](const GenParticle&, double) { return tol; },
+      [tol](const GenParticle& x, const GenParticle& y) {
+        return equal_particles(x, y, tol);
+      },
+      unmatched_a, unmatched_b);
+}
+
+bool equal_vertices(const GenVertex& a, const GenVertex& b, double tol) {
+  return a.status() == b.status() && is_close(a.position(), b.position(), tol) &&
+         match_particles(a.particles_in(), b.particles_in(), tol) &&
+         match_particles(a.particles_out(), b.particles_out(), tol);
+}
+
+bool match_vertices(const std::vector<ConstGenVertexPtr>& a,
+                    const std::vector<ConstGenVertexPtr>& b, double tol,
+                    std::vector<int>* unmatched_a, std::vector<int>* unmatched_b) {
+  // Vertex positions are often all zero, so vertices are sorted by the energy
+  // sum of their particles, which differs by less than tol per particle between
+  // equal vertices, plus some slack for the rounding of the sum.
+  const auto energy = [](const GenVertex& x) {
+    double sum = 0;
+    for (const auto& p : x.particles_in()) sum += p->momentum().e();
+    for (const auto& p : x.particles_out()) sum += p->momentum().e();
+    return sum;
+  };
+  return match_sets(
+      a, b,
+      [](const GenVertex& x) {
+        return std::make_tuple(x.status(), x.particles_in().size(),
+                               x.particles_out().size());
+      },
+      energy,
+      [tol](const GenVertex& x, double t) {
+        const auto n = x.particles_in().size() + x.particles_out().size();
+        return n * tol + 1e-9 * std::abs(t);
+      },
+      [tol](const GenVertex& x, const GenVertex& y) {
+        return equal_vertices(x, y, tol);
+      },
+      unmatched_a, unmatched_b);
+}
+
+bool operator==(const GenParticle& a, const GenParticle& b) {
+  return equal_particles(a, b, default_tolerance);
 }
 
 // compares all real qualities of both particle sets,
 // but ignores the .id() fields and the particle order
 bool equal_particle_sets(const std::vector<ConstGenParticlePtr>& a,
                          const std::vector<ConstGenParticlePtr>& b) {
-  if (a.size() != b.size()) return false;
-  auto unmatched = b;
-  for (auto&& ai : a) {
-    auto it = std::find_if(unmatched.begin(), unmatched.end(),
-                           [ai](ConstGenParticlePtr x) { return *ai == *x; });
-    if (it == unmatched.end()) return false;
-    unmatched.erase(it);
-  }
-  return unmatched.empty();
+  return match_particles(a, b, default_tolerance);
 }
 
-// compares all real qualities of two vertices, but ignores the .id() field
 bool operator==(const GenVertex& a, const GenVertex& b) {
-  return a.status() == b.status() && is_close(a.position(), b.position()) &&
-         equal_particle_sets(a.particles_in(), b.particles_in()) &&
-         equal_particle_sets(a.particles_out(), b.particles_out());
+  return equal_vertices(a, b, default_tolerance);
 }
 
 // compares all real qualities of both vertex sets,
 // but ignores the .id() fields and the vertex order
 bool equal_vertex_sets(const std::vector<ConstGenVertexPtr>& a,
                        const std::vector<ConstGenVertexPtr>& b) {
-  if (a.size() != b.size()) return false;
-  auto unmatched = b;
-  for (auto&& ai : a) {
-    auto it = std::find_if(unmatched.begin(), unmatched.end(),
-                           [ai](ConstGenVertexPtr x) { return *ai == *x; });
-    if (it == unmatched.end()) return false;
-    unmatched.erase(it);
-  }
-  return unmatched.empty();
+  return match_vertices(a, b, default_tolerance);
 }
 
 bool operator==(const GenRunInfo::ToolInfo& a, const GenRunInfo::ToolInfo& b) {
@@ -142,6 +275,14 @@ bool operator==(const HEPEUPAttribute& a, const HEPEUPAttribute& b) {
   return as == bs;
 }
 
+bool equal_run_info(const GenEvent& a, const GenEvent& b) {
+  // run_info may be missing
+  if (a.run_info() && b.run_info()) return *a.run_info() == *b.run_info();
+  if (!a.run_info() && b.run_info()) return *b.run_info() == GenRunInfo();
+  if (a.run_info() && !b.run_info()) return *a.run_info() == GenRunInfo();
+  return true;
+}
+
 bool operator==(const GenEvent& a, const GenEvent& b) {
   // incomplete:
   // missing comparison of GenHeavyIon, GenPdfInfo, GenCrossSection
@@ -150,14 +291,7 @@ bool operator==(const GenEvent& a, const GenEvent& b) {
       a.length_unit() != b.length_unit())
     return false;
 
-  // run_info may be missing
-  if (a.run_info() && b.run_info()) {
-    if (!(*a.run_info() == *b.run_info())) return false;
-  } else if (!a.run_info() && b.run_info()) {
-    if (*b.run_info() != GenRunInfo()) return false;
-  } else if (a.run_info() && !b.run_info()) {
-    if (*a.run_info() != GenRunInfo()) return false;
-  }
+  if (!equal_run_info(a, b)) return false;
 
   // if all vertices compare equal, then also all particles are equal
   return equal_vertex_sets(a.vertices(), b.vertices());
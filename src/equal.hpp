@@ -0,0 +1,41 @@
+#ifndef PYHEPMC_EQUAL_HPP
+#define PYHEPMC_EQUAL_HPP
+
+#include "pointer.hpp"
+#include <HepMC3/FourVector.h>
+#include <vector>
+
+namespace HepMC3 {
+
+// absolute tolerance for momenta and positions used by the equality operators
+constexpr double default_tolerance = 1e-7;
+
+bool is_close(const FourVector& a, const FourVector& b, double tol);
+
+// compares all real qualities of two particles, but ignores the .id() field
+bool equal_particles(const GenParticle& a, const GenParticle& b, double tol);
+
+// compares all real qualities of two vertices, but ignores the .id() field
+bool equal_vertices(const GenVertex& a, const GenVertex& b, double tol);
+
+// Finds a one-to-one mapping between the particles in a and b, ignoring their order.
+// Returns true if all particles are matched. If unmatched_a and unmatched_b are
+// not null, the indices of the particles without partner are appended, otherwise
+// the search stops at the first particle without partner.
+bool match_particles(const std::vector<ConstGenParticlePtr>& a,
+                     const std::vector<ConstGenParticlePtr>& b, double tol,
+                     std::vector<int>* unmatched_a = nullptr,
+                     std::vector<int>* unmatched_b = nullptr);
+
+// same as match_particles for vertices
+bool match_vertices(const std::vector<ConstGenVertexPtr>& a,
+                    const std::vector<ConstGenVertexPtr>& b, double tol,
+                    std::vector<int>* unmatched_a = nullptr,
+                    std::vector<int>* unmatched_b = nullptr);
+
+// compares the run infos of the events, a missing run info is equal to an empty one
+bool equal_run_info(const GenEvent& a, const GenEvent& b);
+
+} // namespace HepMC3
+
+#endif
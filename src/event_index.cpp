@@ -0,0 +1,53 @@
+#include "geneventdata.hpp"
+#include "pybind.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Finds the byte offsets of all lines which start with "E ", these begin an
+// event in HepMC3 and HepMC2 ASCII files. The number after "E " is the event
+// number. Lines are scanned with memchr, no other parsing is done.
+py::tuple event_index(const std::string& filename) {
+  std::vector<std::int64_t> offsets;
+  std::vector<int> numbers;
+  {
+    py::gil_scoped_release release;
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) throw std::runtime_error("cannot open file " + filename);
+    std::vector<char> block(1 << 22);
+    std::string buffer;    // starts with incomplete line from previous block
+    std::int64_t base = 0; // file offset of buffer[0]
+    bool eof = false;
+    while (!eof) {
+      file.read(block.data(), block.size());
+      const auto n = file.gcount();
+      eof = n == 0;
+      buffer.append(block.data(), n);
+      std::size_t pos = 0;
+      for (;;) {
+        const auto nl = static_cast<const char*>(
+            std::memchr(buffer.data() + pos, '\n', buffer.size() - pos));
+        // last line may be incomplete, unless file ends here
+        if (!nl && !eof) break;
+        const std::size_t end = nl ? nl - buffer.data() : buffer.size();
+        if (end - pos >= 2 && buffer[pos] == 'E' && buffer[pos + 1] == ' ') {
+          offsets.push_back(base + pos);
+          // strtol stops at the end of the line, buffer is null-terminated
+          numbers.push_back(std::strtol(buffer.data() + pos + 2, nullptr, 10));
+        }
+        pos = end + 1;
+        if (!nl) break;
+      }
+      pos = std::min(pos, buffer.size());
+      buffer.erase(0, pos);
+      base += pos;
+    }
+  }
+  return py::make_tuple(move_to_array(std::move(offsets)),
+                        move_to_array(std::move(numbers)));
+}
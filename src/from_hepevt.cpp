@@ -1,22 +1,27 @@
+#include "parallel.hpp"
 #include "pybind.hpp"
+#include "writer_ascii_fast.hpp"
 #include <HepMC3/Errors.h>
 #include <HepMC3/GenEvent.h>
 #include <HepMC3/GenParticle.h>
 #include <HepMC3/GenVertex.h>
+#include <HepMC3/Writer.h>
+#include <HepMC3/WriterHEPEVT.h>
+#include <accessor/accessor.hpp>
+#include <algorithm>
 #include <array>
 #include <cassert>
-#include <map>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
-template <>
-struct std::less<std::pair<int, int>> {
-  bool operator()(const std::pair<int, int>& a,
-                  const std::pair<int, int>& b) const noexcept {
-    if (a.first == b.first) return a.second < b.second;
-    return a.first < b.first;
-  }
-};
+MEMBER_ACCESSOR(HE1, HepMC3::WriterHEPEVT, m_stream, std::ostream*)
 
 void normalize(int& m1, int& m2, bool fortran) {
   // normalize mother range, see
@@ -62,109 +67,411 @@ void modded_add_particle_in(int vid, GenVertexPtr v, GenParticlePtr p) {
     v->add_particle_in(p);
 }
 
-void connect_parents_and_children(GenEvent& event, bool parents,
-                                  py::array_t<int> parents_or_children, py::object vx,
-                                  py::object vy, py::object vz, py::object vt,
-                                  bool fortran) {
+namespace {
 
-  if (parents_or_children.request().ndim != 2)
-    throw std::runtime_error("parents or children must be 2D");
+using darray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+using iarray = py::array_t<int, py::array::c_style | py::array::forcecast>;
 
-  auto rco = parents_or_children.unchecked<2>();
+// Raw view on the HEPEVT arrays of one event. Building an event from this view
+// does not touch Python objects, so it can run without the GIL.
+struct hepevt_view {
+  int n = 0;
+  const double *px, *py, *pz, *en, *m;
+  const int *pid, *status;
+  const int* relations = nullptr; // parents or children, shape (n, 2)
+  bool parents = false;
+  const double *vx = nullptr, *vy = nullptr, *vz = nullptr, *vt = nullptr;
+};
 
-  const std::vector<GenParticlePtr>& particles = event.particles();
-  const int n = particles.size();
-  if (rco.shape(0) != n || rco.shape(1) != 2)
-    throw std::runtime_error("parents or children must have shape (N, 2)");
-
-  // find unique vertices:
-  // particles with same parents or children share one vertex
-  // if parents: map from parents to children
-  // if children: map from children to parents
-  std::map<std::pair<int, int>, std::vector<int>> vmap;
-  const int invalid = fortran ? 0 : -1;
-  for (int i = 0; i < n; ++i) {
-    if (rco(i, 0) <= invalid && rco(i, 1) <= invalid) continue;
-    vmap[std::make_pair(rco(i, 0), rco(i, 1))].push_back(i);
+// Converts and validates the input arrays once, for one event or a batch.
+struct hepevt_input {
+  darray px, py, pz, en, m, vx, vy, vz, vt;
+  iarray pid, status, relations;
+  bool parents = false;
+  bool has_vertex = false;
+  py::ssize_t n = 0;
+
+  hepevt_input(py::object opx, py::object opy, py::object opz, py::object oen,
+               py::object om, py::object opid, py::object ostatus, py::object oparents,
+               py::object ochildren, py::object ovx, py::object ovy, py::object ovz,
+               py::object ovt)
+      : px(darray::ensure(opx))
+      , py(darray::ensure(opy))
+      , pz(darray::ensure(opz))
+      , en(darray::ensure(oen))
+      , m(darray::ensure(om))
+      , pid(iarray::ensure(opid))
+      , status(iarray::ensure(ostatus)) {
+    if (!px || px.ndim() != 1) throw std::runtime_error("px must be 1D");
+    if (!py || py.ndim() != 1) throw std::runtime_error("py must be 1D");
+    if (!pz || pz.ndim() != 1) throw std::runtime_error("pz must be 1D");
+    if (!en || en.ndim() != 1) throw std::runtime_error("en must be 1D");
+    if (!m || m.ndim() != 1) throw std::runtime_error("m must be 1D");
+    if (!pid || pid.ndim() != 1) throw std::runtime_error("pid must be 1D");
+    if (!status || status.ndim() != 1) throw std::runtime_error("status must be 1D");
+
+    n = pid.shape(0);
+    if (px.shape(0) != n || py.shape(0) != n || pz.shape(0) != n || en.shape(0) != n ||
+        m.shape(0) != n || status.shape(0) != n)
+      throw std::runtime_error("px, py, pz, en, m, pid, status must have same length");
+
+    const bool have_parents = !oparents.is_none();
+    const bool have_children = !ochildren.is_none();
+    if (!have_parents && !have_children) return;
+
+    parents = have_parents;
+    relations = iarray::ensure(have_parents ? oparents : ochildren);
+    if (!relations || relations.ndim() != 2)
+      throw std::runtime_error("parents or children must be 2D");
+    if (relations.shape(0) != n || relations.shape(1) != 2)
+      throw std::runtime_error("parents or children must have shape (N, 2)");
+
+    const int nvertex = !ovx.is_none() + !ovy.is_none() + !ovz.is_none() + !ovt.is_none();
+    if (nvertex && nvertex != 4)
+      throw std::runtime_error("if one of vx, vy, vz, vt is set, all must be set");
+    has_vertex = nvertex == 4;
+    if (!has_vertex) return;
+
+    vx = darray::ensure(ovx);
+    vy = darray::ensure(ovy);
+    vz = darray::ensure(ovz);
+    vt = darray::ensure(ovt);
+    if (!vx || !vy || !vz || !vt || vx.ndim() != 1 || vy.ndim() != 1 || vz.ndim() != 1 ||
+        vt.ndim() != 1)
+      throw std::runtime_error("vx, vy, vz, vt must be 1D");
+    if (vx.shape(0) != n || vy.shape(0) != n || vz.shape(0) != n || vt.shape(0) != n)
+      throw std::runtime_error("vx, vy, vz, vt must have same length");
   }
 
-  const int has_vertex = !vx.is_none() + !vy.is_none() + !vz.is_none() + !vt.is_none();
+  // view on the particles [begin, end)
+  hepevt_view view(py::ssize_t begin, py::ssize_t end) const {
+    hepevt_view v;
+    v.n = static_cast<int>(end - begin);
+    v.px = px.data() + begin;
+    v.py = py.data() + begin;
+    v.pz = pz.data() + begin;
+    v.en = en.data() + begin;
+    v.m = m.data() + begin;
+    v.pid = pid.data() + begin;
+    v.status = status.data() + begin;
+    if (relations) {
+      v.relations = relations.data() + 2 * begin;
+      v.parents = parents;
+    }
+    if (has_vertex) {
+      v.vx = vx.data() + begin;
+      v.vy = vy.data() + begin;
+      v.vz = vz.data() + begin;
+      v.vt = vt.data() + begin;
+    }
+    return v;
+  }
+};
 
-  if (has_vertex && has_vertex != 4)
-    throw std::runtime_error("if one of vx, vy, vz, vt is set, all must be set");
+// Key which sorts like the pair (m1, m2) of signed ints, the sign bits are
+// flipped so that negative values come first.
+std::uint64_t make_key(int m1, int m2) {
+  const std::uint64_t a = static_cast<std::uint32_t>(m1) ^ 0x80000000u;
+  const std::uint64_t b = static_cast<std::uint32_t>(m2) ^ 0x80000000u;
+  return (a << 32) | b;
+}
 
-  py::array_t<double> avx;
-  py::array_t<double> avy;
-  py::array_t<double> avz;
-  py::array_t<double> avt;
+int key_first(std::uint64_t key) {
+  return static_cast<int>(static_cast<std::uint32_t>(key >> 32) ^ 0x80000000u);
+}
 
-  if (has_vertex) {
-    avx = py::cast<py::array_t<double>>(vx);
-    avy = py::cast<py::array_t<double>>(vy);
-    avz = py::cast<py::array_t<double>>(vz);
-    avt = py::cast<py::array_t<double>>(vt);
+int key_second(std::uint64_t key) {
+  return static_cast<int>(static_cast<std::uint32_t>(key) ^ 0x80000000u);
+}
 
-    if (avx.request().ndim != 1 || avy.request().ndim != 1 || avz.request().ndim != 1 ||
-        avt.request().ndim != 1)
-      throw std::runtime_error("vx, vy, vz, vt must be 1D");
+// Stable LSD radix sort of keys and the associated indices, one byte per pass.
+// Passes over bytes which are equal for all keys are skipped, typically only
+// about half of the passes remain, since m1 and m2 are small. keys2 and idx2 are
+// scratch space.
+void radix_sort(std::vector<std::uint64_t>& keys, std::vector<int>& idx,
+                std::vector<std::uint64_t>& keys2, std::vector<int>& idx2) {
+  const std::size_t n = keys.size();
+  if (n < 2) return;
+  std::array<std::array<std::size_t, 256>, 8> count{};
+  for (const auto k : keys)
+    for (int b = 0; b < 8; ++b) ++count[b][(k >> (8 * b)) & 0xff];
+
+  keys2.resize(n);
+  idx2.resize(n);
+  for (int b = 0; b < 8; ++b) {
+    auto& c = count[b];
+    if (c[(keys[0] >> (8 * b)) & 0xff] == n) continue;
+    std::size_t sum = 0;
+    for (auto& x : c) {
+      const auto t = x;
+      x = sum;
+      sum += t;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto j = c[(keys[i] >> (8 * b)) & 0xff]++;
+      keys2[j] = keys[i];
+      idx2[j] = idx[i];
+    }
+    keys.swap(keys2);
+    idx.swap(idx2);
   }
+}
 
-  auto x = avx.unchecked<1>();
-  auto y = avy.unchecked<1>();
-  auto z = avz.unchecked<1>();
-  auto t = avt.unchecked<1>();
-
-  if (has_vertex &&
-      (x.shape(0) != n || y.shape(0) != n || z.shape(0) != n || t.shape(0) != n))
-    throw std::runtime_error("vx, vy, vz, vt must have same length");
+// Finds the vertices of an event: particles with the same parents or children
+// share one vertex. If parents are given, children are grouped by parents,
+// otherwise parents are grouped by children. Sorting by (m1, m2) yields the groups
+// as contiguous ranges, in the same order as iterating over a std::map, so the
+// vertex order does not depend on the sorting algorithm. The buffers are kept
+// between calls.
+struct vertex_finder {
+  std::vector<std::uint64_t> keys, keys2;
+  std::vector<int> idx, idx2;
+
+  // Calls f(m1, m2, co_begin, co_end) for each vertex in order, where [m1, m2) is
+  // the normalized range of parents or children and [co_begin, co_end) are the
+  // indices of the particles which refer to this range.
+  template <class F>
+  void run(const hepevt_view& in, bool fortran, F&& f) {
+    const int* rco = in.relations;
+    const int n = in.n;
+    keys.clear();
+    idx.clear();
+    const int invalid = fortran ? 0 : -1;
+    for (int i = 0; i < n; ++i) {
+      if (rco[2 * i] <= invalid && rco[2 * i + 1] <= invalid) continue;
+      keys.push_back(make_key(rco[2 * i], rco[2 * i + 1]));
+      idx.push_back(i);
+    }
+    radix_sort(keys, idx, keys2, idx2);
+
+    int nvertex = 0;
+    for (std::size_t begin = 0, end = 0; begin < keys.size(); begin = end) {
+      end = begin + 1;
+      while (end < keys.size() && keys[end] == keys[begin]) ++end;
+
+      int m1 = key_first(keys[begin]);
+      int m2 = key_second(keys[begin]);
+
+      // there must be at least one parent or child when we arrive here...
+      normalize(m1, m2, fortran);
+
+      if (m1 < 0 || m2 > n) {
+        std::ostringstream os;
+        os << "invalid " << (in.parents ? "parents" : "children")
+           << " range for vertex " << nvertex << " [" << m1 << ", " << m2
+           << ") total number of particles " << n;
+        throw std::runtime_error(os.str().c_str());
+      }
+
+      // ...with at least one child or parent, by construction
+      f(m1, m2, idx.data() + begin, idx.data() + end);
+      ++nvertex;
+    }
+  }
+};
 
-  for (const auto& vi : vmap) {
+// Position of the vertex; we assume this is a production vertex. If parents are
+// given, co_first is the first child, otherwise m1 is the first child.
+FourVector vertex_position(const hepevt_view& in, int m1, const int* co_first) {
+  if (!in.vx) return FourVector();
+  const int i = in.parents ? *co_first : m1;
+  return FourVector(in.vx[i], in.vy[i], in.vz[i], in.vt[i]);
+}
 
-    int m1 = vi.first.first;
-    int m2 = vi.first.second;
+// Reusable buffers to format events, one per event in a chunk
+struct ascii_event {
+  vertex_finder finder;
+  std::vector<int> production, end; // vertex index of each particle or -1
+  std::vector<int> in_offsets, in_ids;
+  std::vector<FourVector> position;
+  std::vector<char> written;
+  std::vector<int> out_first, out_last; // range of outgoing particle ids per vertex
+  std::string text;
+};
 
-    // there must be at least one parent or child when we arrive here...
-    normalize(m1, m2, fortran);
+// Tracks the relations which connect_parents_and_children would create with
+// indices, without building a GenEvent.
+void find_vertices(ascii_event& a, const hepevt_view& in, bool fortran) {
+  const int n = in.n;
+  a.production.assign(n, -1);
+  a.end.assign(n, -1);
+  a.position.clear();
+  if (in.relations) {
+    auto add = [&](int m1, int m2, const int* co_begin, const int* co_end) {
+      const int k = a.position.size();
+      a.position.push_back(vertex_position(in, m1, co_begin));
+      if (in.parents) {
+        // modded_add_particle_in keeps the first end vertex
+        for (int i = m1; i < m2; ++i)
+          if (a.end[i] < 0) a.end[i] = k;
+        for (auto it = co_begin; it != co_end; ++it) a.production[*it] = k;
+      } else {
+        // add_particle_out moves the particle to the last production vertex
+        for (int i = m1; i < m2; ++i) a.production[i] = k;
+        for (auto it = co_begin; it != co_end; ++it)
+          if (a.end[*it] < 0) a.end[*it] = k;
+      }
+    };
+    a.finder.run(in, fortran, add);
+  }
+  const int nvertex = a.position.size();
+
+  // ids of the incoming particles of each vertex, sorted by construction;
+  // in_offsets[k] is used as a cursor while filling and shifted back afterwards
+  a.in_offsets.assign(nvertex + 1, 0);
+  for (int i = 0; i < n; ++i)
+    if (a.end[i] >= 0) ++a.in_offsets[a.end[i] + 1];
+  for (int k = 0; k < nvertex; ++k) a.in_offsets[k + 1] += a.in_offsets[k];
+  a.in_ids.resize(a.in_offsets.back());
+  for (int i = 0; i < n; ++i)
+    if (a.end[i] >= 0) a.in_ids[a.in_offsets[a.end[i]]++] = i + 1;
+  for (int k = nvertex; k > 0; --k) a.in_offsets[k] = a.in_offsets[k - 1];
+  a.in_offsets[0] = 0;
+}
 
-    if (m1 < 0 || m2 > n) {
-      std::ostringstream os;
-      os << "invalid " << (parents ? "parents" : "children") << " range for vertex "
-         << event.vertices().size() << " [" << m1 << ", " << m2
-         << ") total number of particles " << n;
-      throw std::runtime_error(os.str().c_str());
+// Formats the event in the HepMC3 ASCII format. The text is the same that
+// WriterAscii produces for the event built by fill_event.
+void format_event(ascii_event& a, int event_number, const hepevt_view& in,
+                  bool fortran, int precision) {
+  find_vertices(a, in, fortran);
+  const int n = in.n;
+  const int nvertex = a.position.size();
+  auto& out = a.text;
+  out.clear();
+  ascii::put_event(out, event_number, nvertex, n, FourVector(), Units::GEV, Units::MM,
+                   precision);
+  a.written.assign(nvertex, 0);
+  for (int i = 0; i < n; ++i) {
+    const int k = a.production[i];
+    int parent = 0;
+    if (k >= 0) {
+      // same logic as in WriterAsciiFast::write_event, the vertex status is zero
+      const int* in_begin = a.in_ids.data() + a.in_offsets[k];
+      const int* in_end = a.in_ids.data() + a.in_offsets[k + 1];
+      if (in_end - in_begin > 1 || !a.position[k].is_zero())
+        parent = -k - 1;
+      else if (in_end - in_begin == 1)
+        parent = *in_begin;
+      if (parent < 0 && !a.written[k]) {
+        a.written[k] = 1;
+        ascii::put_vertex(out, -k - 1, 0, in_begin, in_end, a.position[k], precision);
+      }
     }
+    ascii::put_particle(out, i + 1, parent, in.pid[i],
+                        FourVector(in.px[i], in.py[i], in.pz[i], in.en[i]), in.m[i],
+                        in.status[i], precision);
+  }
+}
 
-    // ...with at least one child or parent
-    const auto& co = vi.second;
+// Formats the event in the text format of WriterHEPEVT. The particles are written
+// in the given order, the parent and child ranges and the production vertex of
+// each particle are those of the event built by fill_event.
+void format_hepevt(ascii_event& a, int event_number, const hepevt_view& in,
+                   bool fortran, bool positions) {
+  find_vertices(a, in, fortran);
+  const int n = in.n;
+  const int nvertex = a.position.size();
+  a.out_first.assign(nvertex, 0);
+  a.out_last.assign(nvertex, 0);
+  for (int i = 0; i < n; ++i) {
+    const int k = a.production[i];
+    if (k < 0) continue;
+    if (!a.out_first[k]) a.out_first[k] = i + 1;
+    a.out_last[k] = i + 1;
+  }
 
-    if (co.empty()) {
-      std::ostringstream os;
-      os << "invalid empty " << (!parents ? "parents" : "children")
-         << " list for vertex " << event.vertices().size();
-      throw std::runtime_error(os.str().c_str());
+  auto& out = a.text;
+  out.clear();
+  // same format as WriterHEPEVT::write_hepevt_event_header and
+  // WriterHEPEVT::write_hepevt_particle
+  char buf[512];
+  out.append(buf, std::snprintf(buf, sizeof(buf), "E% 12i% 12i\n", event_number, n));
+  for (int i = 0; i < n; ++i) {
+    const int k = a.production[i];
+    int parent1 = 0, parent2 = 0;
+    if (k >= 0 && a.in_offsets[k] < a.in_offsets[k + 1]) {
+      parent1 = a.in_ids[a.in_offsets[k]];
+      parent2 = a.in_ids[a.in_offsets[k + 1] - 1];
     }
-    FourVector pos;
-    if (has_vertex) {
-      // we assume this is a production vertex
-      // if parent, co.front() is location of production vertex of first child
-      // if child, we use location of first child m1
-      const int i = parents ? co.front() : m1;
-      pos.set(x(i), y(i), z(i), t(i));
+    const int e = a.end[i];
+    const int child1 = e >= 0 ? a.out_first[e] : 0;
+    const int child2 = e >= 0 ? a.out_last[e] : 0;
+    if (positions) {
+      const FourVector pos = k >= 0 ? a.position[k] : FourVector();
+      out.append(buf, std::snprintf(buf, sizeof(buf),
+                                    "% 8i% 8i% 8i% 8i% 8i% 8i"
+                                    "% 19.8E% 19.8E% 19.8E% 19.8E% 19.8E\n"
+                                    "%-48s% 19.8E% 19.8E% 19.8E% 19.8E\n",
+                                    in.status[i], in.pid[i], parent1, parent2, child1,
+                                    child2, in.px[i], in.py[i], in.pz[i], in.en[i],
+                                    in.m[i], " ", pos.x(), pos.y(), pos.z(), pos.t()));
+    } else {
+      out.append(buf, std::snprintf(buf, sizeof(buf),
+                                    "% 8i% 8i% 8i% 8i% 19.8E% 19.8E% 19.8E% 19.8E\n",
+                                    in.status[i], in.pid[i], child1, child2, in.px[i],
+                                    in.py[i], in.pz[i], in.m[i]));
     }
+  }
+}
+
+// Formats events in chunks on several threads with format(buffer, i) and passes
+// the texts in order to write, without the GIL. The buffers are reused between
+// chunks, so that memory stays bounded for large batches.
+template <class Format, class Write>
+void write_formatted(int nevent, int nchunk, int threads, Format&& format,
+                     Write&& write) {
+  std::vector<ascii_event> buffers(std::min(nevent, nchunk));
+  py::gil_scoped_release release;
+  for (int begin = 0; begin < nevent; begin += nchunk) {
+    const int end = std::min(nevent, begin + nchunk);
+    parallel_for(end - begin, threads, [&](int k) {
+      const int i = begin + k;
+      try {
+        format(buffers[k], i);
+      } catch (std::exception& e) {
+        throw std::runtime_error("event " + std::to_string(i) + ": " + e.what());
+      }
+    });
+    for (int k = 0; k < end - begin; ++k) write(buffers[k].text);
+  }
+}
+
+} // namespace
 
-    GenVertexPtr v{new GenVertex(pos)};
+void connect_parents_and_children(GenEvent& event, const hepevt_view& in, bool fortran) {
+  const bool parents = in.parents;
+  const std::vector<GenParticlePtr>& particles = event.particles();
+  vertex_finder finder;
+  finder.run(in, fortran, [&](int m1, int m2, const int* co_begin, const int* co_end) {
+    GenVertexPtr v{new GenVertex(vertex_position(in, m1, co_begin))};
     int vid = event.vertices().size();
 
     if (parents) {
       for (int k = m1; k < m2; ++k) modded_add_particle_in(vid, v, particles.at(k));
-      for (const auto k : co) v->add_particle_out(particles.at(k));
+      for (auto k = co_begin; k != co_end; ++k) v->add_particle_out(particles.at(*k));
     } else {
       for (int k = m1; k < m2; ++k) v->add_particle_out(particles.at(k));
-      for (const auto k : co) modded_add_particle_in(vid, v, particles.at(k));
+      for (auto k = co_begin; k != co_end; ++k)
+        modded_add_particle_in(vid, v, particles.at(*k));
     }
 
     event.add_vertex(v);
+  });
+}
+
+void fill_event(GenEvent& event, int event_number, const hepevt_view& in, bool fortran) {
+  event.clear();
+  event.reserve(in.n);
+  event.set_event_number(event_number);
+
+  for (int i = 0; i < in.n; ++i) {
+    GenParticlePtr p{new GenParticle(FourVector(in.px[i], in.py[i], in.pz[i], in.en[i]),
+                                     in.pid[i], in.status[i])};
+    p->set_generated_mass(in.m[i]);
+    event.add_particle(p);
   }
+
+  if (in.relations) connect_parents_and_children(event, in, fortran);
 }
 
 void from_hepevt(GenEvent& event, int event_number, py::array_t<double> px,
@@ -172,45 +479,107 @@ void from_hepevt(GenEvent& event, int event_number, py::array_t<double> px,
                  py::array_t<double> m, py::array_t<int> pid, py::array_t<int> status,
                  py::object parents, py::object children, py::object vx, py::object vy,
                  py::object vz, py::object vt, bool fortran) {
-  if (px.request().ndim != 1) throw std::runtime_error("px must be 1D");
-  if (py.request().ndim != 1) throw std::runtime_error("py must be 1D");
-  if (pz.request().ndim != 1) throw std::runtime_error("pz must be 1D");
-  if (en.request().ndim != 1) throw std::runtime_error("en must be 1D");
-  if (m.request().ndim != 1) throw std::runtime_error("m must be 1D");
-  if (pid.request().ndim != 1) throw std::runtime_error("pid must be 1D");
-  if (status.request().ndim != 1) throw std::runtime_error("status must be 1D");
-
-  auto rpx = px.unchecked<1>();
-  auto rpy = py.unchecked<1>();
-  auto rpz = pz.unchecked<1>();
-  auto ren = en.unchecked<1>();
-  auto rm = m.unchecked<1>();
-  auto rpid = pid.unchecked<1>();
-  auto rsta = status.unchecked<1>();
-
-  const int n = pid.shape(0);
-  if (rpx.shape(0) != n || rpy.shape(0) != n || rpz.shape(0) != n ||
-      ren.shape(0) != n || rm.shape(0) != n)
-    throw std::runtime_error("px, py, pz, en, m, pid, status must have same length");
+  hepevt_input in(px, py, pz, en, m, pid, status, parents, children, vx, vy, vz, vt);
+  fill_event(event, event_number, in.view(0, in.n), fortran);
+}
 
-  event.clear();
-  event.reserve(n);
-  event.set_event_number(event_number);
+py::object from_hepevt_batch(py::array_t<std::int64_t> offsets, py::object px,
+                             py::object py, py::object pz, py::object en, py::object m,
+                             py::object pid, py::object status, py::object parents,
+                             py::object children, py::object vx, py::object vy,
+                             py::object vz, py::object vt, py::object event_number,
+                             bool fortran, int threads, py::object writer) {
+  hepevt_input in(px, py, pz, en, m, pid, status, parents, children, vx, vy, vz, vt);
+
+  if (offsets.ndim() != 1 || offsets.shape(0) < 1)
+    throw std::runtime_error("offsets must be 1D and not empty");
+  const int nevent = offsets.shape(0) - 1;
+  auto off = offsets.unchecked<1>();
+  for (int i = 0; i < nevent; ++i) {
+    if (off(i) < 0 || off(i) > off(i + 1) || off(i + 1) > in.n)
+      throw std::runtime_error("offsets must be increasing and within [0, N]");
+  }
 
-  for (int i = 0; i < n; ++i) {
-    GenParticlePtr p{
-        new GenParticle(FourVector(rpx(i), rpy(i), rpz(i), ren(i)), rpid(i), rsta(i))};
-    p->set_generated_mass(rm(i));
-    event.add_particle(p);
+  std::vector<int> numbers(nevent);
+  if (event_number.is_none()) {
+    for (int i = 0; i < nevent; ++i) numbers[i] = i;
+  } else {
+    auto a = iarray::ensure(event_number);
+    if (!a || a.ndim() != 1 || a.shape(0) != nevent)
+      throw std::runtime_error("event_number must be 1D with one entry per event");
+    std::copy(a.data(), a.data() + nevent, numbers.begin());
   }
 
-  const bool have_parents = !parents.is_none();
-  const bool have_children = !children.is_none();
-  if (have_parents || have_children)
-    connect_parents_and_children(
-        event, have_parents,
-        py::cast<py::array_t<int>>(have_parents ? parents : children), vx, vy, vz, vt,
-        fortran);
+  std::vector<hepevt_view> views(nevent);
+  for (int i = 0; i < nevent; ++i) views[i] = in.view(off(i), off(i + 1));
+
+  // write in chunks, so that memory stays bounded for large batches
+  const int nchunk = 64 * resolve_nthreads(threads);
+
+  // WriterAsciiFast and WriterHEPEVT get the text directly
+  if (!writer.is_none() && py::isinstance<WriterAsciiFast>(writer)) {
+    auto& fast = py::cast<WriterAsciiFast&>(writer);
+    const int precision = fast.precision();
+    write_formatted(
+        nevent, nchunk, threads,
+        [&](ascii_event& a, int i) {
+          format_event(a, numbers[i], views[i], fortran, precision);
+        },
+        [&](const std::string& text) { fast.write_formatted(text); });
+    if (fast.failed()) throw std::runtime_error("writing GenEvent failed");
+    return py::int_(nevent);
+  }
+
+  if (!writer.is_none() && py::isinstance<WriterHEPEVT>(writer)) {
+    auto& hepevt = py::cast<WriterHEPEVT&>(writer);
+    const bool positions = hepevt.vertices_positions_present();
+    std::ostream* os = accessor::accessMember<HE1>(hepevt).get();
+    write_formatted(
+        nevent, nchunk, threads,
+        [&](ascii_event& a, int i) {
+          format_hepevt(a, numbers[i], views[i], fortran, positions);
+        },
+        [&](const std::string& text) { os->write(text.data(), text.size()); });
+    if (hepevt.failed()) throw std::runtime_error("writing GenEvent failed");
+    return py::int_(nevent);
+  }
+
+  Writer* cwriter = nullptr;
+  if (!writer.is_none() && py::isinstance<Writer>(writer))
+    cwriter = py::cast<Writer*>(writer);
+  const int chunk = writer.is_none() ? std::max(nevent, 1) : nchunk;
+
+  py::list result;
+  std::vector<GenEventPtr> events;
+  for (int begin = 0; begin < nevent; begin += chunk) {
+    const int end = std::min(nevent, begin + chunk);
+    events.resize(end - begin);
+    {
+      py::gil_scoped_release release;
+      parallel_for(end - begin, threads, [&](int k) {
+        const int i = begin + k;
+        events[k] = std::make_shared<GenEvent>();
+        try {
+          fill_event(*events[k], numbers[i], views[i], fortran);
+        } catch (std::exception& e) {
+          throw std::runtime_error("event " + std::to_string(i) + ": " + e.what());
+        }
+      });
+      if (cwriter) {
+        for (auto& event : events) cwriter->write_event(*event);
+      }
+    }
+    if (cwriter) {
+      if (cwriter->failed()) throw std::runtime_error("writing GenEvent failed");
+    } else if (!writer.is_none()) {
+      auto write = writer.attr("write");
+      for (auto& event : events) write(event);
+    } else {
+      for (auto& event : events) result.append(py::cast(event));
+    }
+  }
+  if (writer.is_none()) return result;
+  return py::int_(nevent);
 }
 
 } // namespace HepMC3
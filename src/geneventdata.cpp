@@ -2,22 +2,12 @@
 #include <HepMC3/Data/GenEventData.h>
 #include <HepMC3/Data/GenParticleData.h>
 #include <HepMC3/Data/GenVertexData.h>
+#include <cstring>
+#include <string>
+#include <vector>
 
 using namespace HepMC3;
 
-struct ParticleData {
-  int pid;
-  int status;
-  bool is_mass_set;
-  double mass;
-  double px, py, pz, e;
-};
-
-struct VertexData {
-  int status;
-  double x, y, z, t;
-};
-
 void register_geneventdata_dtypes() {
   PYBIND11_NUMPY_DTYPE(ParticleData, pid, status, is_mass_set, mass, px, py, pz, e);
   PYBIND11_NUMPY_DTYPE(VertexData, status, x, y, z, t);
@@ -37,6 +27,24 @@ MAKE(particles, ParticleData)
 MAKE(links1, int)
 MAKE(links2, int)
 
+// copies the array into the vector, this is a single memcpy if the array is
+// contiguous and has the right dtype, otherwise numpy converts it first
+#define MAKE_SET(name, type)                                                  \
+  void GenEventData_set_##name(GenEventData& s, input_array<type> a) {        \
+    using value_type = decltype(s.name)::value_type;                          \
+    static_assert(sizeof(type) == sizeof(value_type), "layout must match");   \
+    if (a.ndim() != 1) throw py::value_error(#name " must be 1D");            \
+    s.name.resize(a.shape(0));                                                \
+    if (a.shape(0) > 0)                                                       \
+      std::memcpy(s.name.data(), a.data(), a.shape(0) * sizeof(type));        \
+  }
+
+MAKE_SET(weights, double)
+MAKE_SET(vertices, VertexData)
+MAKE_SET(particles, ParticleData)
+MAKE_SET(links1, int)
+MAKE_SET(links2, int)
+
 #define MAKES(name)                                 \
   py::object GenEventData_##name(py::object self) { \
     auto& s = py::cast<GenEventData&>(self);        \
@@ -48,3 +56,15 @@ MAKE(links2, int)
 MAKES(attribute_id)
 MAKES(attribute_name)
 MAKES(attribute_string)
+
+void GenEventData_set_attribute_id(GenEventData& s, std::vector<int> v) {
+  s.attribute_id = std::move(v);
+}
+
+void GenEventData_set_attribute_name(GenEventData& s, std::vector<std::string> v) {
+  s.attribute_name = std::move(v);
+}
+
+void GenEventData_set_attribute_string(GenEventData& s, std::vector<std::string> v) {
+  s.attribute_string = std::move(v);
+}
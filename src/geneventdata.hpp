@@ -2,6 +2,42 @@
 #define PYHEPMC_GENEVENTDATA_HPP
 
 #include "pybind.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace HepMC3 {
+struct GenEventData;
+}
+
+// These mirror the memory layout of GenParticleData and GenVertexData,
+// so that the internal vectors of GenEventData can be viewed as numpy arrays
+struct ParticleData {
+  int pid;
+  int status;
+  bool is_mass_set;
+  double mass;
+  double px, py, pz, e;
+};
+
+struct VertexData {
+  int status;
+  double x, y, z, t;
+};
+
+// transfers ownership of the vector to the array, no copy is made
+template <class T>
+py::array move_to_array(std::vector<T>&& v, py::dtype dt) {
+  auto p = new std::vector<T>(std::move(v));
+  py::capsule owner(p, [](void* x) { delete static_cast<std::vector<T>*>(x); });
+  py::ssize_t shape[1] = {static_cast<py::ssize_t>(p->size())};
+  return py::array(dt, shape, p->data(), owner);
+}
+
+template <class T>
+py::array move_to_array(std::vector<T>&& v) {
+  return move_to_array(std::move(v), py::dtype::of<T>());
+}
 
 py::object GenEventData_particles(py::object);
 py::object GenEventData_vertices(py::object);
@@ -12,6 +48,19 @@ py::object GenEventData_attribute_id(py::object);
 py::object GenEventData_attribute_name(py::object);
 py::object GenEventData_attribute_string(py::object);
 
+// array argument which numpy converts to the dtype and memory layout if necessary
+template <class T>
+using input_array = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+void GenEventData_set_particles(HepMC3::GenEventData&, input_array<ParticleData>);
+void GenEventData_set_vertices(HepMC3::GenEventData&, input_array<VertexData>);
+void GenEventData_set_weights(HepMC3::GenEventData&, input_array<double>);
+void GenEventData_set_links1(HepMC3::GenEventData&, input_array<int>);
+void GenEventData_set_links2(HepMC3::GenEventData&, input_array<int>);
+void GenEventData_set_attribute_id(HepMC3::GenEventData&, std::vector<int>);
+void GenEventData_set_attribute_name(HepMC3::GenEventData&, std::vector<std::string>);
+void GenEventData_set_attribute_string(HepMC3::GenEventData&, std::vector<std::string>);
+
 void register_geneventdata_dtypes();
 
 #endif
@@ -1,7 +1,13 @@
 #include "UnparsedAttribute.hpp"
+#include "columnar.hpp"
+#include "decompress_iostream.hpp"
+#include "mmap_iostream.hpp"
+#include "prefetch_iostream.hpp"
 #include "pybind.hpp"
 #include "pyiostream.hpp"
+#include "reader_ascii_parallel.hpp"
 #include "repr.hpp"
+#include "writer_ascii_fast.hpp"
 #include <HepMC3/GenRunInfo.h>
 #include <HepMC3/Reader.h>
 #include <HepMC3/ReaderAscii.h>
@@ -11,6 +17,7 @@
 #include <HepMC3/WriterAscii.h>
 #include <HepMC3/WriterAsciiHepMC2.h>
 #include <HepMC3/WriterHEPEVT.h>
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -25,11 +32,31 @@ using ReaderAsciiHepMC2Ptr = std::shared_ptr<ReaderAsciiHepMC2>;
 using ReaderLHEFPtr = std::shared_ptr<ReaderLHEF>;
 using ReaderHEPEVTPtr = std::shared_ptr<ReaderHEPEVT>;
 
+namespace HepMC3 {
+py::dict read_batch(Reader& reader, int n);
+} // namespace HepMC3
+
+py::tuple event_index(const std::string& filename);
+
 #ifdef HEPMC3_ROOTIO
 using ReaderRootTreePtr = std::shared_ptr<ReaderRootTree>;
 using ReaderRootPtr = std::shared_ptr<ReaderRoot>;
 #endif
 
+namespace {
+
+// The columnar format is binary, but the streams of pyhepmc turn \r into \n when
+// reading, which would corrupt the data.
+std::iostream& binary_stream(std::iostream& s) {
+  if (dynamic_cast<pyiostream*>(&s) || dynamic_cast<mmap_iostream*>(&s) ||
+      dynamic_cast<decompress_iostream*>(&s) || dynamic_cast<prefetch_iostream*>(&s))
+    throw py::type_error(
+        "columnar format requires a binary-safe stream, like stringstream");
+  return s;
+}
+
+} // namespace
+
 void register_io(py::module& m) {
 
   py::module_ m_doc = py::module_::import("pyhepmc._doc");
@@ -47,7 +74,7 @@ void register_io(py::module& m) {
              if (size > 1024) throw std::runtime_error("size must be <= 1024");
              char buffer[1024];
              self.read(buffer, size);
-             return py::bytes(buffer);
+             return py::bytes(buffer, self.gcount());
            })
       .def("write",
            [](std::iostream& self, py::bytes s) {
@@ -57,6 +84,13 @@ void register_io(py::module& m) {
                py::pybind11_fail("Unable to extract bytes contents!");
              self.write(buffer, length);
            })
+      .def("seekg",
+           [](std::iostream& self, std::int64_t pos) {
+             self.clear();
+             if (!self.seekg(pos)) throw std::runtime_error("stream cannot seek");
+           })
+      .def("tellg",
+           [](std::iostream& self) { return static_cast<std::int64_t>(self.tellg()); })
       // clang-format off
       METH(flush, pyiostream)
       // clang-format on
@@ -65,6 +99,21 @@ void register_io(py::module& m) {
   py::class_<pyiostream, std::iostream>(m, "pyiostream")
       .def(py::init<py::object, int>(), "file_object"_a, "buffer_size"_a = 4096);
 
+  py::class_<decompress_iostream, std::iostream>(m, "decompress_iostream")
+      .def(py::init<std::string, int>(), "filename"_a, "buffer_size"_a = 1 << 16);
+
+  py::class_<mmap_iostream, std::iostream>(m, "mmap_iostream")
+      .def(py::init<std::string>(), "filename"_a);
+
+  py::class_<prefetch_iostream, std::iostream>(m, "prefetch_iostream")
+      .def(py::init<std::iostream&, int, int>(), "source"_a, "nbuffers"_a = 4,
+           "buffer_size"_a = 1 << 20, py::keep_alive<1, 2>())
+      .def("close", &prefetch_iostream::close);
+
+  m.def("_event_index", event_index, "filename"_a);
+
+  m.attr("_native_decompression") = py::tuple(py::cast(decompress_streambuf::suffixes()));
+
   // this class is here to simplify unit testing of Readers and Writers
   py::class_<std::stringstream, std::iostream>(m, "stringstream")
       .def(py::init<>())
@@ -72,19 +121,30 @@ void register_io(py::module& m) {
       .def("__str__",
            (std::string (std::stringstream::*)() const) & std::stringstream::str);
 
+  // Readers and Writers release the GIL while parsing or formatting; pystreambuf
+  // reacquires it only around the calls into the Python file object
   py::class_<Reader>(m, "Reader")
       // clang-format off
-      METH(read_event, Reader, "event"_a)
+      METH(read_event, Reader, "event"_a, py::call_guard<py::gil_scoped_release>())
       METH(failed, Reader)
-      METH(close, Reader)
+      METH(close, Reader, py::call_guard<py::gil_scoped_release>())
       PROP2(options, Reader)
       // clang-format on
-      ;
+      .def("read_batch", read_batch, "n"_a, DOC(Reader.read_batch));
 
   py::class_<ReaderAscii, Reader>(m, "ReaderAscii")
       .def(py::init<const std::string>(), "filename"_a)
       .def(py::init<std::iostream&>(), "istream"_a, py::keep_alive<1, 2>());
 
+  py::class_<ReaderAsciiParallel, Reader>(m, "ReaderAsciiParallel",
+                                         DOC(ReaderAsciiParallel))
+      .def(py::init<const std::string&, int, int>(), "filename"_a, "threads"_a = 0,
+           "batch_size"_a = 256)
+      .def(py::init<std::iostream&, int, int>(), "istream"_a, "threads"_a = 0,
+           "batch_size"_a = 256, py::keep_alive<1, 2>())
+      .def("_read", &ReaderAsciiParallel::read,
+           py::call_guard<py::gil_scoped_release>());
+
   py::class_<ReaderAsciiHepMC2, Reader>(m, "ReaderAsciiHepMC2")
       .def(py::init<const std::string>(), "filename"_a)
       .def(py::init<std::iostream&>(), "istream"_a, py::keep_alive<1, 2>());
@@ -97,11 +157,21 @@ void register_io(py::module& m) {
       .def(py::init<const std::string>(), "filename"_a)
       .def(py::init<std::iostream&>(), "istream"_a, py::keep_alive<1, 2>());
 
+  py::class_<ReaderColumnar, Reader>(m, "ReaderColumnar", DOC(ReaderColumnar))
+      .def(py::init<const std::string&>(), "filename"_a)
+      .def(py::init([](std::iostream& s) {
+             return new ReaderColumnar(binary_stream(s));
+           }),
+           "istream"_a, py::keep_alive<1, 2>())
+      .def("num_events", &ReaderColumnar::num_events, DOC(ReaderColumnar.num_events))
+      .def("seek_event", &ReaderColumnar::seek_event, "index"_a,
+           DOC(ReaderColumnar.seek_event));
+
   py::class_<Writer>(m, "Writer")
       // clang-format off
-      METH(write_event, Writer, "event"_a)
+      METH(write_event, Writer, "event"_a, py::call_guard<py::gil_scoped_release>())
       METH(failed, Writer)
-      METH(close, Writer)
+      METH(close, Writer, py::call_guard<py::gil_scoped_release>())
       PROP2(options, Writer)
       // clang-format on
       ;
@@ -117,6 +187,26 @@ void register_io(py::module& m) {
       // clang-format on
       ;
 
+  py::class_<WriterAsciiFast, Writer>(m, "WriterAsciiFast", DOC(WriterAsciiFast))
+      .def(py::init<const std::string&, GenRunInfoPtr>(), "filename"_a,
+           "run"_a = nullptr)
+      .def(py::init<std::iostream&, GenRunInfoPtr>(), "ostream"_a, "run"_a = nullptr,
+           py::keep_alive<1, 2>())
+      // clang-format off
+      PROP(precision, WriterAsciiFast)
+      // clang-format on
+      ;
+
+  py::class_<WriterColumnar, Writer>(m, "WriterColumnar", DOC(WriterColumnar))
+      .def(py::init<const std::string&, GenRunInfoPtr, int, int>(), "filename"_a,
+           "run"_a = nullptr, "batch_size"_a = 1000, "compression"_a = 3)
+      .def(py::init([](std::iostream& s, GenRunInfoPtr run, int batch_size,
+                       int compression) {
+             return new WriterColumnar(binary_stream(s), run, batch_size, compression);
+           }),
+           "ostream"_a, "run"_a = nullptr, "batch_size"_a = 1000, "compression"_a = 3,
+           py::keep_alive<1, 2>());
+
   py::class_<WriterAsciiHepMC2, Writer>(m, "WriterAsciiHepMC2")
       .def(py::init<const std::string&, GenRunInfoPtr>(), "filename"_a,
            "run"_a = nullptr)
@@ -0,0 +1,133 @@
+#include "mmap_iostream.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// upper limit for the size of the get area, so that the search for \r
+// proceeds together with the parser instead of touching all pages at once
+constexpr std::size_t view_size = 1 << 20;
+} // namespace
+
+#ifdef _WIN32
+mmap_streambuf::mmap_streambuf(const std::string& filename) {
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    throw std::runtime_error("cannot open file " + filename);
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    throw std::runtime_error("cannot get size of file " + filename);
+  }
+  size_ = static_cast<std::size_t>(size.QuadPart);
+  if (size_ > 0) {
+    mapping_ = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (mapping_)
+      data_ = static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_COPY, 0, 0, 0));
+  }
+  CloseHandle(file);
+  if (size_ > 0 && !data_) {
+    if (mapping_) CloseHandle(mapping_);
+    throw std::runtime_error("cannot map file " + filename);
+  }
+  setg(data_, data_, data_);
+}
+
+mmap_streambuf::~mmap_streambuf() {
+  if (data_) UnmapViewOfFile(data_);
+  if (mapping_) CloseHandle(mapping_);
+}
+#else
+mmap_streambuf::mmap_streambuf(const std::string& filename) {
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("cannot open file " + filename);
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("cannot get size of file " + filename);
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+  if (size_ > 0) {
+    void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("cannot map file " + filename);
+    }
+    data_ = static_cast<char*>(p);
+    // the readers parse front to back, this enables aggressive read-ahead
+    ::madvise(data_, size_, MADV_SEQUENTIAL);
+  }
+  // the mapping stays valid after the descriptor is closed
+  ::close(fd);
+  setg(data_, data_, data_);
+}
+
+mmap_streambuf::~mmap_streambuf() {
+  if (data_) ::munmap(data_, size_);
+}
+#endif
+
+mmap_streambuf::int_type mmap_streambuf::underflow() {
+  if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+  char* const end = data_ + size_;
+  char* start = egptr();
+  if (skip_next_) {
+    skip_next_ = false;
+    if (start < end && *start == '\n') ++start;
+  }
+  if (start == end) {
+    setg(data_, end, end);
+    return traits_type::eof();
+  }
+  char* stop = start + std::min(view_size, static_cast<std::size_t>(end - start));
+  auto cr = static_cast<char*>(std::memchr(start, '\r', stop - start));
+  if (cr) {
+    // turn \r into \n and end the view there, the next \n is skipped
+    *cr = '\n';
+    stop = cr + 1;
+    skip_next_ = true;
+  }
+  setg(data_, start, stop);
+  return traits_type::to_int_type(*gptr());
+}
+
+mmap_streambuf::pos_type mmap_streambuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                 std::ios_base::openmode which) {
+  off_type base = 0;
+  if (dir == std::ios_base::cur) {
+    base = gptr() - data_;
+    // a pending skip means that the \n of a \r\n pair was not consumed yet
+    if (skip_next_ && gptr() == egptr() && gptr() < data_ + size_ && *gptr() == '\n')
+      ++base;
+  } else if (dir == std::ios_base::end) {
+    base = static_cast<off_type>(size_);
+  }
+  return seekpos(pos_type(base + off), which);
+}
+
+mmap_streambuf::pos_type mmap_streambuf::seekpos(pos_type pos,
+                                                 std::ios_base::openmode which) {
+  const off_type p = pos;
+  if (!(which & std::ios_base::in) || p < 0 || p > static_cast<off_type>(size_))
+    return pos_type(off_type(-1));
+  skip_next_ = false;
+  setg(data_, data_ + p, data_ + p);
+  return pos;
+}
+
+// mmap_streambuf must be initialized before std::iostream
+mmap_iostream::mmap_iostream(const std::string& filename)
+    : std::iostream(new mmap_streambuf(filename)) {}
+
+mmap_iostream::~mmap_iostream() { delete rdbuf(nullptr); }
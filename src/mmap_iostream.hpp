@@ -0,0 +1,41 @@
+#ifndef PYHEPMC_MMAP_IOSTREAM_HPP
+#define PYHEPMC_MMAP_IOSTREAM_HPP
+
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+// Reads a file through a private memory mapping. The get area points
+// directly into the mapped pages, so the data is not copied before parsing.
+//
+// HepMC3 expects \n as line terminator. Like pystreambuf, we turn \r into \n
+// and skip the following \n. The mapping is copy-on-write, so that only pages
+// which contain \r are copied and the file itself is never modified.
+class mmap_streambuf : public std::streambuf {
+  char* data_ = nullptr;
+  std::size_t size_ = 0;
+  bool skip_next_ = false;
+#ifdef _WIN32
+  void* mapping_ = nullptr;
+#endif
+
+public:
+  explicit mmap_streambuf(const std::string& filename);
+  ~mmap_streambuf();
+
+  mmap_streambuf(const mmap_streambuf&) = delete;
+  mmap_streambuf& operator=(const mmap_streambuf&) = delete;
+
+  int_type underflow() override;
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override;
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+};
+
+class mmap_iostream : public std::iostream {
+public:
+  explicit mmap_iostream(const std::string& filename);
+  ~mmap_iostream();
+};
+
+#endif
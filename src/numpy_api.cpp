@@ -1,59 +1,682 @@
 #include "numpy_api.hpp"
+#include "attributes_view.hpp"
+#include "geneventdata.hpp"
+#include "parallel.hpp"
+#include <HepMC3/Attribute.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
 
-#define NP_ARRAY(cls, kind, type, method)                           \
-  .def_property_readonly(#method, [](cls& self) {                   \
-    using namespace HepMC3;                                         \
-    const GenEvent& event = py::cast<const GenEvent&>(self.event_); \
-    const auto& x = event.kind();                                   \
-    py::array_t<type> a(x.size());                                  \
-    auto a2 = a.mutable_unchecked<1>();                             \
-    for (size_t i = 0; i < x.size(); ++i) a2[i] = x[i]->method();   \
-    return a;                                                       \
-  })
-
-#define NP_ARRAY2(cls, kind, type, method1, method2)                         \
-  .def_property_readonly(#method2, [](cls& self) {                           \
-    using namespace HepMC3;                                                  \
-    const GenEvent& event = py::cast<const GenEvent&>(self.event_);          \
-    const auto& x = event.kind();                                            \
-    py::array_t<type> a(x.size());                                           \
-    auto a2 = a.mutable_unchecked<1>();                                      \
-    for (size_t i = 0; i < x.size(); ++i) a2[i] = x[i]->method1().method2(); \
-    return a;                                                                \
-  })
+namespace {
+
+using namespace HepMC3;
+
+// A column describes how to extract one field from a particle or vertex.
+// All requested columns are filled in a single pass over the event. A single
+// column is filled by array, which loops over the objects without an indirect
+// call per element.
+template <class T>
+struct Column {
+  const char* name;
+  py::dtype (*dtype)();
+  void (*fill)(const T&, char*);
+  py::array (*array)(const std::vector<std::shared_ptr<const T>>&);
+};
+
+#define COLUMN(cls, type, name, expr)                                      \
+  Column<cls> {                                                            \
+    #name, []() { return py::dtype::of<type>(); },                         \
+        [](const cls& x, char* out) {                                      \
+          *reinterpret_cast<type*>(out) = static_cast<type>(expr);         \
+        },                                                                 \
+        [](const std::vector<std::shared_ptr<const cls>>& objects) {       \
+          py::array_t<type> a(objects.size());                             \
+          type* out = a.mutable_data();                                    \
+          for (const auto& p : objects) {                                  \
+            const cls& x = *p;                                             \
+            *out++ = static_cast<type>(expr);                              \
+          }                                                                \
+          return py::array(std::move(a));                                  \
+        }                                                                  \
+  }
+
+// Vertex ids are -1, -2, ..., so the index in event.vertices() is -id - 1;
+// -1 means no vertex.
+int vertex_index(const ConstGenVertexPtr& v) { return v ? -v->id() - 1 : -1; }
+
+const std::vector<Column<GenParticle>>& particle_columns() {
+  static const std::vector<Column<GenParticle>> columns = {
+      COLUMN(GenParticle, int, id, x.id()),
+      COLUMN(GenParticle, int, pid, x.pid()),
+      COLUMN(GenParticle, int, status, x.status()),
+      COLUMN(GenParticle, bool, is_generated_mass_set, x.is_generated_mass_set()),
+      COLUMN(GenParticle, double, generated_mass, x.generated_mass()),
+      COLUMN(GenParticle, double, px, x.momentum().px()),
+      COLUMN(GenParticle, double, py, x.momentum().py()),
+      COLUMN(GenParticle, double, pz, x.momentum().pz()),
+      COLUMN(GenParticle, double, e, x.momentum().e()),
+      // derived kinematics, computed with the FourVector methods
+      COLUMN(GenParticle, double, pt, x.momentum().pt()),
+      COLUMN(GenParticle, double, eta, x.momentum().eta()),
+      COLUMN(GenParticle, double, phi, x.momentum().phi()),
+      COLUMN(GenParticle, double, rap, x.momentum().rap()),
+      COLUMN(GenParticle, double, m, x.momentum().m()),
+      COLUMN(GenParticle, double, p3mod, x.momentum().p3mod()),
+      COLUMN(GenParticle, int, production_vertex, vertex_index(x.production_vertex())),
+      COLUMN(GenParticle, int, end_vertex, vertex_index(x.end_vertex())),
+  };
+  return columns;
+}
+
+const std::vector<Column<GenVertex>>& vertex_columns() {
+  static const std::vector<Column<GenVertex>> columns = {
+      COLUMN(GenVertex, int, id, x.id()),
+      COLUMN(GenVertex, int, status, x.status()),
+      COLUMN(GenVertex, bool, has_set_position, x.has_set_position()),
+      COLUMN(GenVertex, double, x, x.position().x()),
+      COLUMN(GenVertex, double, y, x.position().y()),
+      COLUMN(GenVertex, double, z, x.position().z()),
+      COLUMN(GenVertex, double, t, x.position().t()),
+  };
+  return columns;
+}
+
+template <class T>
+const Column<T>* find_column(const std::vector<Column<T>>& columns,
+                             const std::string& name) {
+  for (const auto& c : columns)
+    if (name == c.name) return &c;
+  throw py::key_error(name);
+  return nullptr;
+}
+
+template <class T>
+std::vector<const Column<T>*> select_columns(const std::vector<Column<T>>& columns,
+                                             py::object fields) {
+  std::vector<const Column<T>*> result;
+  if (fields.is_none()) {
+    for (const auto& c : columns) result.push_back(&c);
+  } else {
+    for (auto f : fields) result.push_back(find_column(columns, py::cast<std::string>(f)));
+  }
+  return result;
+}
+
+template <class T, class Ptr>
+void fill_columns(const std::vector<Ptr>& objects,
+                  const std::vector<const Column<T>*>& columns,
+                  const std::vector<char*>& data,
+                  const std::vector<py::ssize_t>& strides) {
+  const std::size_t n = objects.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    const T& x = *objects[i];
+    for (std::size_t j = 0; j < columns.size(); ++j)
+      columns[j]->fill(x, data[j] + i * strides[j]);
+  }
+}
+
+template <class T, class Ptr>
+py::dict to_columns(const std::vector<Ptr>& objects,
+                    const std::vector<const Column<T>*>& columns) {
+  const py::ssize_t n = objects.size();
+  py::dict result;
+  std::vector<char*> data;
+  std::vector<py::ssize_t> strides;
+  for (const auto c : columns) {
+    py::array a(c->dtype(), {n});
+    data.push_back(static_cast<char*>(a.mutable_data()));
+    strides.push_back(a.itemsize());
+    result[c->name] = a;
+  }
+  fill_columns(objects, columns, data, strides);
+  return result;
+}
+
+// fills user-provided arrays, which may be larger than needed and strided;
+// returns the number of entries written
+template <class T, class Ptr>
+py::ssize_t to_columns(const std::vector<Ptr>& objects,
+                       const std::vector<const Column<T>*>& columns, py::dict out) {
+  const py::ssize_t n = objects.size();
+  std::vector<char*> data;
+  std::vector<py::ssize_t> strides;
+  for (const auto c : columns) {
+    if (!out.contains(c->name)) throw py::key_error(c->name);
+    py::object obj = out[c->name];
+    if (!py::isinstance<py::array>(obj))
+      throw py::type_error(std::string("out[\"") + c->name + "\"] is not an array");
+    auto a = py::reinterpret_borrow<py::array>(obj);
+    const auto dt = c->dtype();
+    // equal() also compares the byte order
+    if (a.ndim() != 1 || !a.dtype().equal(dt))
+      throw py::value_error(std::string("out[\"") + c->name +
+                            "\"] must be 1D with dtype " +
+                            py::cast<std::string>(py::str(dt)));
+    if (a.shape(0) < n)
+      throw py::value_error(std::string("out[\"") + c->name + "\"] is too small");
+    data.push_back(static_cast<char*>(a.mutable_data()));
+    strides.push_back(a.strides(0));
+  }
+  fill_columns(objects, columns, data, strides);
+  return n;
+}
+
+template <class API, class T>
+void def_columns(py::class_<API>& cls, const std::vector<Column<T>>& columns,
+                 py::object (*to_records)(const GenEvent&, py::object)) {
+  const auto* pcolumns = &columns;
+  cls.def(py::init<py::object>())
+      .def("__len__", [](API& self) { return self.objects().size(); })
+      .def(
+          "to_records",
+          [to_records](API& self, py::object out) {
+            return to_records(self.event(), out);
+          },
+          "out"_a = py::none())
+      .def(
+          "to_columns",
+          [pcolumns](API& self, py::object fields, py::object out) -> py::object {
+            if (out.is_none())
+              return to_columns<T>(self.objects(), select_columns(*pcolumns, fields));
+            auto d = py::cast<py::dict>(out);
+            if (fields.is_none()) fields = d.attr("keys")();
+            return py::int_(
+                to_columns<T>(self.objects(), select_columns(*pcolumns, fields), d));
+          },
+          "fields"_a = py::none(), "out"_a = py::none())
+      .def_static("dtypes", [pcolumns]() {
+        py::dict result;
+        for (const auto& c : *pcolumns) result[c.name] = c.dtype();
+        return result;
+      });
+  for (const auto& c : columns) {
+    const Column<T>* pc = &c;
+    cls.def_property_readonly(c.name,
+                              [pc](API& self) { return pc->array(self.objects()); });
+  }
+}
+
+template <class T>
+py::array_t<T> records_out(py::object out, py::ssize_t n) {
+  if (out.is_none()) return py::array_t<T>(n);
+  if (!py::isinstance<py::array_t<T>>(out))
+    throw py::type_error("out must be an array with matching dtype");
+  auto a = py::reinterpret_borrow<py::array_t<T>>(out);
+  if (a.ndim() != 1 || a.shape(0) < n)
+    throw py::value_error("out must be 1D and large enough");
+  return a;
+}
+
+py::object particles_to_records(const GenEvent& event, py::object out) {
+  const auto& particles = event.particles();
+  auto a = records_out<ParticleData>(out, particles.size());
+  auto r = a.mutable_unchecked<1>();
+  for (std::size_t i = 0; i < particles.size(); ++i) {
+    const GenParticleData& pd = particles[i]->data();
+    ParticleData& d = r(i);
+    d.pid = pd.pid;
+    d.status = pd.status;
+    d.is_mass_set = pd.is_mass_set;
+    d.mass = pd.mass;
+    d.px = pd.momentum.px();
+    d.py = pd.momentum.py();
+    d.pz = pd.momentum.pz();
+    d.e = pd.momentum.e();
+  }
+  if (!out.is_none()) return py::int_(particles.size());
+  return std::move(a);
+}
+
+py::object vertices_to_records(const GenEvent& event, py::object out) {
+  const auto& vertices = event.vertices();
+  auto a = records_out<VertexData>(out, vertices.size());
+  auto r = a.mutable_unchecked<1>();
+  for (std::size_t i = 0; i < vertices.size(); ++i) {
+    const GenVertexData& vd = vertices[i]->data();
+    VertexData& d = r(i);
+    d.status = vd.status;
+    d.x = vd.position.x();
+    d.y = vd.position.y();
+    d.z = vd.position.z();
+    d.t = vd.position.t();
+  }
+  if (!out.is_none()) return py::int_(vertices.size());
+  return std::move(a);
+}
+
+// Connectivity of one or several events. Particles and vertices are referred to
+// by their index in the concatenated particle and vertex arrays.
+struct Graph {
+  std::vector<int> production_vertex, end_vertex; // per particle, -1 if none
+  std::vector<std::int64_t> in_offsets{0}, out_offsets{0}; // CSR, per vertex + 1
+  std::vector<int> in_index, out_index;
+  std::vector<int> src, dst; // particle-to-particle edges through vertices
+  std::vector<std::int64_t> particle_offsets{0}, vertex_offsets{0}; // per event + 1
+};
+
+// Appends the connectivity of the event in one pass over its vertices. Each
+// incoming particle of a vertex gets an edge to each outgoing particle.
+void append_graph(const GenEvent& event, Graph& g) {
+  const int pbase = g.production_vertex.size();
+  const int vbase = g.in_offsets.size() - 1;
+  const int n = event.particles().size();
+  g.production_vertex.resize(pbase + n, -1);
+  g.end_vertex.resize(pbase + n, -1);
+  int k = vbase;
+  for (const auto& v : event.vertices()) {
+    const auto& in = v->particles_in();
+    const auto& out = v->particles_out();
+    for (const auto& p : in) {
+      const int i = pbase + p->id() - 1;
+      g.end_vertex[i] = k;
+      g.in_index.push_back(i);
+    }
+    for (const auto& p : out) {
+      const int i = pbase + p->id() - 1;
+      g.production_vertex[i] = k;
+      g.out_index.push_back(i);
+    }
+    for (const auto& a : in) {
+      for (const auto& b : out) {
+        g.src.push_back(pbase + a->id() - 1);
+        g.dst.push_back(pbase + b->id() - 1);
+      }
+    }
+    g.in_offsets.push_back(g.in_index.size());
+    g.out_offsets.push_back(g.out_index.size());
+    ++k;
+  }
+  g.particle_offsets.push_back(pbase + n);
+  g.vertex_offsets.push_back(k);
+}
+
+py::object edge_index(Graph& g) {
+  const py::ssize_t n = g.src.size();
+  g.src.insert(g.src.end(), g.dst.begin(), g.dst.end());
+  return move_to_array(std::move(g.src)).attr("reshape")(2, n);
+}
+
+py::dict graph_to_dict(Graph&& g, bool batch) {
+  py::dict result;
+  result["production_vertex"] = move_to_array(std::move(g.production_vertex));
+  result["end_vertex"] = move_to_array(std::move(g.end_vertex));
+  result["particles_in_offsets"] = move_to_array(std::move(g.in_offsets));
+  result["particles_in"] = move_to_array(std::move(g.in_index));
+  result["particles_out_offsets"] = move_to_array(std::move(g.out_offsets));
+  result["particles_out"] = move_to_array(std::move(g.out_index));
+  result["edge_index"] = edge_index(g);
+  if (batch) {
+    result["particle_offsets"] = move_to_array(std::move(g.particle_offsets));
+    result["vertex_offsets"] = move_to_array(std::move(g.vertex_offsets));
+  }
+  return result;
+}
+
+Graph make_graph(const GenEvent& event) {
+  Graph g;
+  py::gil_scoped_release release;
+  append_graph(event, g);
+  return g;
+}
+
+py::dict graph_batch(py::iterable events) {
+  std::vector<py::object> objects;
+  const auto pevents = collect_events(events, objects);
+  Graph g;
+  {
+    py::gil_scoped_release release;
+    for (const auto* event : pevents) append_graph(*event, g);
+  }
+  return graph_to_dict(std::move(g), true);
+}
+
+const std::vector<ConstGenParticlePtr>& event_particles(const GenEvent& event) {
+  return event.particles();
+}
+
+const std::vector<ConstGenVertexPtr>& event_vertices(const GenEvent& event) {
+  return event.vertices();
+}
+
+// Batched to_columns: the columns of all events are concatenated, the events are
+// processed in parallel without the GIL.
+template <class T, class Ptr>
+py::dict columns_batch(py::iterable events, const std::vector<Column<T>>& all,
+                       py::object fields,
+                       const std::vector<Ptr>& (*objects)(const GenEvent&),
+                       int threads) {
+  const auto columns = select_columns(all, fields);
+  std::vector<py::object> keep;
+  const auto pevents = collect_events(events, keep);
+  const int nevent = pevents.size();
+
+  std::vector<std::int64_t> offsets(nevent + 1, 0);
+  for (int i = 0; i < nevent; ++i)
+    offsets[i + 1] = offsets[i] + objects(*pevents[i]).size();
+
+  py::dict result;
+  std::vector<char*> data;
+  std::vector<py::ssize_t> strides;
+  for (const auto c : columns) {
+    py::array a(c->dtype(), {static_cast<py::ssize_t>(offsets.back())});
+    data.push_back(static_cast<char*>(a.mutable_data()));
+    strides.push_back(a.itemsize());
+    result[c->name] = a;
+  }
+  {
+    py::gil_scoped_release release;
+    parallel_for(nevent, threads, [&](int i) {
+      auto d = data;
+      for (std::size_t j = 0; j < d.size(); ++j) d[j] += offsets[i] * strides[j];
+      fill_columns(objects(*pevents[i]), columns, d, strides);
+    });
+  }
+  result["offsets"] = move_to_array(std::move(offsets));
+  return result;
+}
+
+const char* skip_space(const char* p) {
+  while (std::isspace(static_cast<unsigned char>(*p))) ++p;
+  return p;
+}
+
+// true if a number was parsed and only whitespace follows it
+bool parsed_all(const char* begin, const char* end) {
+  return end != begin && *skip_space(end) == '\0';
+}
+
+template <class T>
+typename std::enable_if<std::is_signed<T>::value && std::is_integral<T>::value,
+                        bool>::type
+parse_number(const char* begin, T& x) {
+  char* end = nullptr;
+  errno = 0;
+  const long long v = std::strtoll(begin, &end, 10);
+  if (!parsed_all(begin, end) || errno == ERANGE ||
+      v < static_cast<long long>(std::numeric_limits<T>::min()) ||
+      v > static_cast<long long>(std::numeric_limits<T>::max()))
+    return false;
+  x = static_cast<T>(v);
+  return true;
+}
+
+template <class T>
+typename std::enable_if<std::is_unsigned<T>::value, bool>::type parse_number(
+    const char* begin, T& x) {
+  // strtoull accepts negative numbers and wraps them around
+  if (*skip_space(begin) == '-') return false;
+  char* end = nullptr;
+  errno = 0;
+  const unsigned long long v = std::strtoull(begin, &end, 10);
+  if (!parsed_all(begin, end) || errno == ERANGE ||
+      v > static_cast<unsigned long long>(std::numeric_limits<T>::max()))
+    return false;
+  x = static_cast<T>(v);
+  return true;
+}
+
+template <class T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type parse_number(
+    const char* begin, T& x) {
+  char* end = nullptr;
+  const double v = std::strtod(begin, &end);
+  if (!parsed_all(begin, end)) return false;
+  x = static_cast<T>(v);
+  return true;
+}
+
+// Parses the string representation of an attribute value. The whole string must
+// be a number which fits into T, "1.5" or "12abc" are not integers.
+template <class T>
+bool parse_value(const std::string& s, T& x) {
+  return parse_number(s.c_str(), x);
+}
+
+bool parse_value(const std::string& s, bool& x) {
+  const bool t = s == "true" || s == "1";
+  if (!t && s != "false" && s != "0") return false;
+  x = t;
+  return true;
+}
+
+// Converts the value of a parsed attribute with the same rules as parse_value:
+// integers must be in the range of T, floating point values must also be
+// integral to be converted to an integer type.
+template <class T, class V>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type convert_value(
+    V v, T& x) {
+  x = static_cast<T>(v);
+  return true;
+}
+
+template <class V>
+bool convert_value(V v, bool& x) {
+  if (v != 0 && v != 1) return false;
+  x = v != 0;
+  return true;
+}
+
+template <class T, class V>
+typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                            std::is_integral<V>::value,
+                        bool>::type
+convert_value(V v, T& x) {
+  if (v < 0 ? !std::is_signed<T>::value ||
+                  static_cast<long long>(v) <
+                      static_cast<long long>(std::numeric_limits<T>::min())
+            : static_cast<unsigned long long>(v) >
+                  static_cast<unsigned long long>(std::numeric_limits<T>::max()))
+    return false;
+  x = static_cast<T>(v);
+  return true;
+}
+
+template <class T, class V>
+typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                            std::is_floating_point<V>::value,
+                        bool>::type
+convert_value(V v, T& x) {
+  // valid range is [-2^digits, 2^digits) for signed and [0, 2^digits) for unsigned
+  // types, both bounds are exact in double; NaN fails the comparison
+  const double upper = std::ldexp(1.0, std::numeric_limits<T>::digits);
+  const double lower = std::is_signed<T>::value ? -upper : 0.0;
+  if (!(v >= lower && v < upper) || v != std::trunc(v)) return false;
+  x = static_cast<T>(v);
+  return true;
+}
+
+// Extracts a numeric value from an attribute. Common parsed types are read
+// directly, other parsed types through to_string. Unparsed attributes are
+// parsed from their string, without converting the attribute itself. Both
+// paths accept the same values.
+template <class T>
+bool attribute_value(const Attribute& a, T& x) {
+  if (!a.is_parsed()) return parse_value(a.unparsed_string(), x);
+  const auto& t = typeid(a);
+  // unary + promotes the value of BoolAttribute to int
+#define PYHEPMC_ATTRIBUTE_VALUE(type)                                 \
+  if (t == typeid(type))                                              \
+    return convert_value(+static_cast<const type&>(a).value(), x);
+  PYHEPMC_ATTRIBUTE_VALUE(IntAttribute)
+  PYHEPMC_ATTRIBUTE_VALUE(LongAttribute)
+  PYHEPMC_ATTRIBUTE_VALUE(LongLongAttribute)
+  PYHEPMC_ATTRIBUTE_VALUE(DoubleAttribute)
+  PYHEPMC_ATTRIBUTE_VALUE(FloatAttribute)
+  PYHEPMC_ATTRIBUTE_VALUE(BoolAttribute)
+#undef PYHEPMC_ATTRIBUTE_VALUE
+  std::string s;
+  return a.to_string(s) && parse_value(s, x);
+}
+
+template <class T>
+T default_value() {
+  if (std::is_floating_point<T>::value) return std::numeric_limits<T>::quiet_NaN();
+  return T{};
+}
+
+// Fills the array with the attribute values of the particles (sign = 1) or
+// vertices (sign = -1) in one pass over the attribute map of the event.
+template <class T>
+void fill_attribute(const AttributesView::AttributeMap& amap, const std::string& name,
+                    int sign, py::array& a, py::object default_) {
+  const T def = default_.is_none() ? default_value<T>() : py::cast<T>(default_);
+  T* out = static_cast<T*>(a.mutable_data());
+  const std::size_t n = a.shape(0);
+  std::fill(out, out + n, def);
+  auto it = amap.find(name);
+  if (it == amap.end()) return;
+  for (const auto& kv : it->second) {
+    // particle ids are positive, vertex ids negative
+    const int id = sign * kv.first;
+    if (id <= 0 || static_cast<std::size_t>(id) > n) continue;
+    if (!attribute_value(*kv.second, out[id - 1]))
+      throw py::value_error("attribute " + name + " with id " +
+                            std::to_string(kv.first) + " is not a number");
+  }
+}
+
+py::array attribute_column(py::object event, int sign, std::size_t n,
+                           const std::string& name, py::object dtype,
+                           py::object default_) {
+  auto& amap = AttributesView{&py::cast<GenEvent&>(event), 0}.attributes();
+  const auto dt = py::dtype::from_args(dtype);
+  py::array a(dt, {static_cast<py::ssize_t>(n)});
+  const auto size = dt.itemsize();
+  switch (dt.kind()) {
+    case 'b': fill_attribute<bool>(amap, name, sign, a, default_); break;
+    case 'i':
+      if (size == 1) fill_attribute<std::int8_t>(amap, name, sign, a, default_);
+      if (size == 2) fill_attribute<std::int16_t>(amap, name, sign, a, default_);
+      if (size == 4) fill_attribute<std::int32_t>(amap, name, sign, a, default_);
+      if (size == 8) fill_attribute<std::int64_t>(amap, name, sign, a, default_);
+      break;
+    case 'u':
+      if (size == 1) fill_attribute<std::uint8_t>(amap, name, sign, a, default_);
+      if (size == 2) fill_attribute<std::uint16_t>(amap, name, sign, a, default_);
+      if (size == 4) fill_attribute<std::uint32_t>(amap, name, sign, a, default_);
+      if (size == 8) fill_attribute<std::uint64_t>(amap, name, sign, a, default_);
+      break;
+    case 'f':
+      if (size == 4) fill_attribute<float>(amap, name, sign, a, default_);
+      if (size == 8) fill_attribute<double>(amap, name, sign, a, default_);
+      if (size == 4 || size == 8) break;
+      // fall through
+    default:
+      throw py::type_error("dtype must be bool, integer, float32, or float64");
+  }
+  return a;
+}
+
+} // namespace
+
+std::vector<const HepMC3::GenEvent*> collect_events(py::iterable events,
+                                                    std::vector<py::object>& objects) {
+  std::vector<const HepMC3::GenEvent*> result;
+  for (auto obj : events) {
+    objects.push_back(py::reinterpret_borrow<py::object>(obj));
+    result.push_back(&py::cast<const HepMC3::GenEvent&>(obj));
+  }
+  return result;
+}
+
+const HepMC3::GenEvent& NumpyAPI::event() const {
+  return py::cast<const HepMC3::GenEvent&>(event_);
+}
+
+const std::vector<HepMC3::ConstGenParticlePtr>& ParticlesAPI::objects() const {
+  return event().particles();
+}
+
+const std::vector<HepMC3::ConstGenVertexPtr>& VerticesAPI::objects() const {
+  return event().vertices();
+}
 
 void register_numpy_api(py::module& m) {
-  py::class_<ParticlesAPI>(m, "ParticlesAPI")
-      .def(py::init<py::object>())
-      // clang-format off
-      NP_ARRAY(ParticlesAPI, particles, int, id)
-      NP_ARRAY(ParticlesAPI, particles, int, pid)
-      NP_ARRAY(ParticlesAPI, particles, int, status)
-      NP_ARRAY(ParticlesAPI, particles, bool, is_generated_mass_set)
-      NP_ARRAY(ParticlesAPI, particles, double, generated_mass)
-      NP_ARRAY2(ParticlesAPI, particles, double, momentum, px)
-      NP_ARRAY2(ParticlesAPI, particles, double, momentum, py)
-      NP_ARRAY2(ParticlesAPI, particles, double, momentum, pz)
-      NP_ARRAY2(ParticlesAPI, particles, double, momentum, e)
-      // clang-format on
-      ;
-
-  py::class_<VerticesAPI>(m, "VerticesAPI")
-      .def(py::init<py::object>())
-      // clang-format off
-      NP_ARRAY(VerticesAPI, vertices, int, id)
-      NP_ARRAY(VerticesAPI, vertices, int, status)
-      NP_ARRAY(VerticesAPI, vertices, bool, has_set_position)
-      NP_ARRAY2(VerticesAPI, vertices, double, position, x)
-      NP_ARRAY2(VerticesAPI, vertices, double, position, y)
-      NP_ARRAY2(VerticesAPI, vertices, double, position, z)
-      NP_ARRAY2(VerticesAPI, vertices, double, position, t)
-      // clang-format on
-      ;
+  py::module_ m_doc = py::module_::import("pyhepmc._doc");
+  auto doc = py::cast<std::map<std::string, std::string>>(m_doc.attr("doc"));
+
+  py::class_<ParticlesAPI> clsParticlesAPI(m, "ParticlesAPI");
+  def_columns(clsParticlesAPI, particle_columns(), particles_to_records);
+  clsParticlesAPI.def_property_readonly(
+      "edge_index",
+      [](ParticlesAPI& self) {
+        auto g = make_graph(self.event());
+        return edge_index(g);
+      },
+      DOC(ParticlesAPI.edge_index));
+  clsParticlesAPI.def(
+      "attribute",
+      [](ParticlesAPI& self, const std::string& name, py::object dtype,
+         py::object default_) {
+        return attribute_column(self.event_, 1, self.objects().size(), name, dtype,
+                                default_);
+      },
+      "name"_a, "dtype"_a = py::none(), "default"_a = py::none(),
+      DOC(ParticlesAPI.attribute));
+
+  py::class_<VerticesAPI> clsVerticesAPI(m, "VerticesAPI");
+  def_columns(clsVerticesAPI, vertex_columns(), vertices_to_records);
+  clsVerticesAPI
+      .def_property_readonly(
+          "particles_in",
+          [](VerticesAPI& self) {
+            auto g = make_graph(self.event());
+            return py::make_tuple(move_to_array(std::move(g.in_offsets)),
+                                  move_to_array(std::move(g.in_index)));
+          },
+          DOC(VerticesAPI.particles_in))
+      .def_property_readonly(
+          "particles_out",
+          [](VerticesAPI& self) {
+            auto g = make_graph(self.event());
+            return py::make_tuple(move_to_array(std::move(g.out_offsets)),
+                                  move_to_array(std::move(g.out_index)));
+          },
+          DOC(VerticesAPI.particles_out))
+      .def(
+          "attribute",
+          [](VerticesAPI& self, const std::string& name, py::object dtype,
+             py::object default_) {
+            return attribute_column(self.event_, -1, self.objects().size(), name,
+                                    dtype, default_);
+          },
+          "name"_a, "dtype"_a = py::none(), "default"_a = py::none(),
+          DOC(VerticesAPI.attribute));
 
   py::class_<NumpyAPI>(m, "NumpyAPI")
       .def_property_readonly("particles",
                              [](NumpyAPI& self) { return ParticlesAPI(self.event_); })
       .def_property_readonly("vertices",
-                             [](NumpyAPI& self) { return VerticesAPI(self.event_); });
+                             [](NumpyAPI& self) { return VerticesAPI(self.event_); })
+      .def(
+          "graph",
+          [](NumpyAPI& self) { return graph_to_dict(make_graph(self.event()), false); },
+          DOC(NumpyAPI.graph));
+
+  m.def("graph_batch", graph_batch, "events"_a, DOC(graph_batch));
+
+  m.def(
+      "particles_batch",
+      [](py::iterable events, py::object fields, int threads) {
+        return columns_batch(events, particle_columns(), fields, event_particles,
+                             threads);
+      },
+      "events"_a, "fields"_a = py::none(), "threads"_a = 0, DOC(particles_batch));
+
+  m.def(
+      "vertices_batch",
+      [](py::iterable events, py::object fields, int threads) {
+        return columns_batch(events, vertex_columns(), fields, event_vertices, threads);
+      },
+      "events"_a, "fields"_a = py::none(), "threads"_a = 0, DOC(vertices_batch));
 }
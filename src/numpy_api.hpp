@@ -6,21 +6,30 @@
 #include <HepMC3/GenVertex.h>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
+#include <vector>
 
 namespace py = pybind11;
 
 struct NumpyAPI {
   py::object event_;
   NumpyAPI(py::object event) : event_{event} {}
+  const HepMC3::GenEvent& event() const;
 };
 
 struct ParticlesAPI : NumpyAPI {
   using NumpyAPI::NumpyAPI;
+  const std::vector<HepMC3::ConstGenParticlePtr>& objects() const;
 };
 struct VerticesAPI : NumpyAPI {
   using NumpyAPI::NumpyAPI;
+  const std::vector<HepMC3::ConstGenVertexPtr>& objects() const;
 };
 
+// Returns pointers to the events; objects keeps the events alive, since the
+// iterable may be a generator.
+std::vector<const HepMC3::GenEvent*> collect_events(py::iterable events,
+                                                    std::vector<py::object>& objects);
+
 void register_numpy_api(py::module& m);
 
 #endif
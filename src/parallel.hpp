@@ -0,0 +1,118 @@
+#ifndef PYHEPMC_PARALLEL_HPP
+#define PYHEPMC_PARALLEL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of threads to use; values <= 0 select the number of hardware threads.
+inline int resolve_nthreads(int nthreads) {
+  if (nthreads > 0) return nthreads;
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Calls f(i) for i in [0, n) on up to nthreads threads, each thread handles
+// a contiguous range of indices. The first exception thrown by f is rethrown
+// after all threads have finished.
+template <class F>
+void parallel_for(int n, int nthreads, F&& f) {
+  nthreads = std::min(resolve_nthreads(nthreads), n);
+  if (nthreads <= 1) {
+    for (int i = 0; i < n; ++i) f(i);
+    return;
+  }
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors(nthreads);
+  for (int t = 0; t < nthreads; ++t) {
+    const int begin = static_cast<long long>(n) * t / nthreads;
+    const int end = static_cast<long long>(n) * (t + 1) / nthreads;
+    threads.emplace_back([&f, &errors, t, begin, end] {
+      try {
+        for (int i = begin; i < end; ++i) f(i);
+      } catch (...) { errors[t] = std::current_exception(); }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (auto& error : errors)
+    if (error) std::rethrow_exception(error);
+}
+
+// Persistent threads which run f(i) for i in [0, n) in the background. Unlike
+// parallel_for, no threads are started per call, and the caller can do other work
+// until it calls wait(). Only one set of tasks can be in flight at a time.
+class worker_pool {
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable work_, done_;
+  std::function<void(int)> f_;
+  int n_ = 0, next_ = 0, pending_ = 0;
+  bool stop_ = false;
+  std::exception_ptr error_;
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      work_.wait(lock, [this] { return stop_ || next_ < n_; });
+      if (stop_) return;
+      const int i = next_++;
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        f_(i);
+      } catch (...) { error = std::current_exception(); }
+      lock.lock();
+      if (error && !error_) error_ = error;
+      if (--pending_ == 0) done_.notify_all();
+    }
+  }
+
+public:
+  explicit worker_pool(int nthreads) {
+    nthreads = resolve_nthreads(nthreads);
+    for (int t = 0; t < nthreads; ++t) threads_.emplace_back([this] { run(); });
+  }
+
+  // tasks which have not started yet are skipped
+  ~worker_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_.notify_all();
+    for (auto& thread : threads_) thread.join();
+  }
+
+  worker_pool(const worker_pool&) = delete;
+  worker_pool& operator=(const worker_pool&) = delete;
+
+  // starts the tasks and returns immediately; the previous tasks must be finished
+  void submit(int n, std::function<void(int)> f) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      f_ = std::move(f);
+      n_ = pending_ = n;
+      next_ = 0;
+      error_ = nullptr;
+    }
+    work_.notify_all();
+  }
+
+  // waits until all tasks are finished, rethrows the first exception of a task
+  void wait() {
+    std::exception_ptr error;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_.wait(lock, [this] { return pending_ == 0; });
+      n_ = next_ = 0;
+      f_ = nullptr;
+      std::swap(error, error_);
+    }
+    if (error) std::rethrow_exception(error);
+  }
+};
+
+#endif
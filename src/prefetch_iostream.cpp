@@ -0,0 +1,104 @@
+#include "prefetch_iostream.hpp"
+#include "pybind.hpp"
+#include <stdexcept>
+
+namespace {
+
+// The background thread may need the GIL, if the source is a pyiostream.
+// Waiting for it while holding the GIL would then deadlock.
+template <class F>
+void without_gil(F&& f) {
+  if (PyGILState_Check()) {
+    py::gil_scoped_release release;
+    f();
+  } else {
+    f();
+  }
+}
+
+} // namespace
+
+prefetch_streambuf::prefetch_streambuf(std::streambuf* source, int nbuffers, int size)
+    : source_(source) {
+  if (nbuffers < 2) throw std::invalid_argument("nbuffers must be at least 2");
+  if (size < 1) throw std::invalid_argument("size must be positive");
+  buffers_.assign(nbuffers, std::vector<char>(size));
+  sizes_.assign(nbuffers, 0);
+  thread_ = std::thread(&prefetch_streambuf::run, this);
+}
+
+prefetch_streambuf::~prefetch_streambuf() { stop(); }
+
+void prefetch_streambuf::run() {
+  std::size_t i = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_full_.wait(lock, [this] { return stop_ || count_ < buffers_.size(); });
+      if (stop_) return;
+    }
+    // buffer i is not visible to the consumer, so we can fill it without lock
+    std::size_t n = 0;
+    std::exception_ptr error;
+    try {
+      n = source_->sgetn(buffers_[i].data(), buffers_[i].size());
+    } catch (...) { error = std::current_exception(); }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      sizes_[i] = n;
+      if (n > 0) ++count_;
+      if (n == 0 || error) {
+        eof_ = true;
+        error_ = error;
+      }
+    }
+    not_empty_.notify_one();
+    if (n == 0 || error) return;
+    i = (i + 1) % buffers_.size();
+  }
+}
+
+prefetch_streambuf::int_type prefetch_streambuf::underflow() {
+  if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+  std::exception_ptr error;
+  without_gil([&] {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (consuming_) {
+      // hand the consumed buffer back to the background thread
+      consuming_ = false;
+      --count_;
+      head_ = (head_ + 1) % buffers_.size();
+      not_full_.notify_one();
+    }
+    not_empty_.wait(lock, [this] { return count_ > 0 || eof_; });
+    if (count_ > 0) {
+      consuming_ = true;
+      auto& b = buffers_[head_];
+      setg(b.data(), b.data(), b.data() + sizes_[head_]);
+    } else {
+      error = error_;
+    }
+  });
+  if (error) std::rethrow_exception(error);
+  if (gptr() == egptr()) return traits_type::eof();
+  return traits_type::to_int_type(*gptr());
+}
+
+void prefetch_streambuf::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    eof_ = true;
+  }
+  not_empty_.notify_all();
+  not_full_.notify_all();
+  if (thread_.joinable()) without_gil([this] { thread_.join(); });
+}
+
+// prefetch_streambuf must be initialized before std::iostream
+prefetch_iostream::prefetch_iostream(std::iostream& source, int nbuffers, int size)
+    : std::iostream(new prefetch_streambuf(source.rdbuf(), nbuffers, size)) {}
+
+prefetch_iostream::~prefetch_iostream() { delete rdbuf(nullptr); }
+
+void prefetch_iostream::close() { static_cast<prefetch_streambuf*>(rdbuf())->stop(); }
@@ -0,0 +1,49 @@
+#ifndef PYHEPMC_PREFETCH_IOSTREAM_HPP
+#define PYHEPMC_PREFETCH_IOSTREAM_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+// Reads ahead from another stream in a background thread. The thread fills
+// a ring of buffers while the parser consumes the previous one, so that file
+// reads and decompression overlap with parsing.
+class prefetch_streambuf : public std::streambuf {
+  std::streambuf* source_;
+  std::vector<std::vector<char>> buffers_;
+  std::vector<std::size_t> sizes_;
+  std::size_t head_ = 0;  // buffer that is consumed next
+  std::size_t count_ = 0; // number of filled buffers
+  bool consuming_ = false;
+  bool eof_ = false;
+  bool stop_ = false;
+  std::exception_ptr error_;
+  std::mutex mutex_;
+  std::condition_variable not_empty_, not_full_;
+  std::thread thread_;
+
+  void run();
+
+public:
+  prefetch_streambuf(std::streambuf* source, int nbuffers, int size);
+  ~prefetch_streambuf();
+
+  int_type underflow() override;
+
+  // stops and joins the background thread, idempotent
+  void stop();
+};
+
+class prefetch_iostream : public std::iostream {
+public:
+  prefetch_iostream(std::iostream& source, int nbuffers, int size);
+  ~prefetch_iostream();
+
+  void close();
+};
+
+#endif
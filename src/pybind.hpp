@@ -32,6 +32,8 @@ _T overload_cast(_T x) {
   .def_property(#name, &cls::name, &cls::set_##name, DOC(cls.name))
 #define PROP2(name, cls) \
   .def_property(#name, &cls::get_##name, &cls::set_##name, DOC(cls.name))
+#define PROP3(name, cls) \
+  .def_property(#name, cls##_##name, cls##_set_##name, DOC(cls.name))
 #define PROP_OL(name, cls, rval)                                                     \
   .def_property(#name, overload_cast<rval, const cls>(&cls::name), &cls::set_##name, \
                 DOC(cls.name))
@@ -61,9 +61,18 @@ from pyhepmc._core import (
     delta_r2_rap,
     delta_r_rap,
     delta_rap,
+    graph_batch,
+    particles_batch,
+    vertices_batch,
 )
 from pyhepmc.io import open as open  # noqa: F401
+from pyhepmc._columns import ColumnBuffer
+from pyhepmc._process import process
+from pyhepmc._hepevt import from_hepevt_batch, to_hepevt_batch
+from pyhepmc._diff import diff, EventDiff, FileDiff
+from pyhepmc._queue import EventQueue, EventRecord
 from pyhepmc import _attributes
+from pyhepmc import _pickle
 from pyhepmc._setup import Setup
 from pyhepmc.view import to_dot
 from typing import Any
@@ -99,9 +108,22 @@ __all__ = (
     "delta_r_rap",
     "delta_rap",
     "open",
+    "ColumnBuffer",
+    "process",
+    "from_hepevt_batch",
+    "to_hepevt_batch",
+    "graph_batch",
+    "particles_batch",
+    "vertices_batch",
+    "diff",
+    "EventDiff",
+    "FileDiff",
+    "EventQueue",
+    "EventRecord",
 )
 
 _attributes.install()
+_pickle.install()
 
 GenEvent._repr_html_ = lambda self: to_dot(self)._repr_html_()
 
@@ -0,0 +1,65 @@
+from __future__ import annotations
+from typing import Any, Dict, Iterable, Optional
+import numpy as np
+
+
+class ColumnBuffer:
+    """
+    Reusable output buffer for the NumPy API.
+
+    The buffer holds one array per field, which is refilled event after event with
+    :meth:`fill`. The arrays only grow, geometrically, if an event has more entries
+    than the current capacity, so that an event loop quickly stops allocating memory.
+
+    Parameters
+    ----------
+    fields : iterable of str
+        Names of the columns to fill, e.g. ``["px", "py", "pid"]``. Allowed names are
+        the keys of ``ParticlesAPI.dtypes()`` or ``VerticesAPI.dtypes()``.
+    capacity : int, optional
+        Initial number of entries per column (default: 0).
+
+    Examples
+    --------
+    >>> buf = ColumnBuffer(["px", "py"])
+    >>> for evt in f:
+    ...     c = buf.fill(evt.numpy.particles)
+    ...     pt = np.hypot(c["px"], c["py"])
+    """
+
+    def __init__(self, fields: Iterable[str], capacity: int = 0):
+        self._fields = list(fields)
+        self._capacity = capacity
+        self._arrays: Optional[Dict[str, np.ndarray]] = None
+        self._size = 0
+
+    @property
+    def capacity(self) -> int:
+        """Number of entries that fit into the buffer without reallocation."""
+        return self._capacity
+
+    def __len__(self) -> int:
+        """Number of entries written by the last call to :meth:`fill`."""
+        return self._size
+
+    def _reserve(self, api: Any, n: int) -> Dict[str, np.ndarray]:
+        if self._arrays is None or n > self._capacity:
+            if n > self._capacity:
+                self._capacity = max(n, 2 * self._capacity)
+            dtypes = api.dtypes()
+            self._arrays = {
+                k: np.empty(self._capacity, dtype=dtypes[k]) for k in self._fields
+            }
+        return self._arrays
+
+    def fill(self, api: Any) -> Dict[str, np.ndarray]:
+        """
+        Fill the buffer from ``evt.numpy.particles`` or ``evt.numpy.vertices``.
+
+        Returns a dict of views into the internal arrays which have the length of the
+        current event. The views are overwritten by the next call to :meth:`fill`,
+        copy them if you need to keep the data.
+        """
+        arrays = self._reserve(api, len(api))
+        self._size = api.to_columns(out=arrays)
+        return {k: v[: self._size] for k, v in arrays.items()}
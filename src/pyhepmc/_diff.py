@@ -0,0 +1,123 @@
+from __future__ import annotations
+from ._core import GenEvent, _diff, _diff_batch
+from ._process import _batches
+from .io import Filename, open
+import dataclasses
+import numpy as np
+from typing import Dict, List, Optional, Union
+
+__all__ = ("diff", "EventDiff", "FileDiff")
+
+
+@dataclasses.dataclass
+class EventDiff:
+    """
+    Differences between two events a and b.
+
+    Particles and vertices are matched like in :func:`equal_particle_sets` and
+    :func:`equal_vertex_sets`. The arrays contain the indices of the objects which
+    have no partner in the other event, in :attr:`GenEvent.particles` and
+    :attr:`GenEvent.vertices`, respectively.
+
+    Attributes
+    ----------
+    header : list of str
+        Fields of the events which differ, out of event_number, momentum_unit,
+        length_unit, weights, event_pos, run_info.
+    particles_a, particles_b : array of int
+        Indices of unmatched particles in a and b.
+    vertices_a, vertices_b : array of int
+        Indices of unmatched vertices in a and b.
+    attributes : list of str
+        Names of event attributes which are missing in one event or have different
+        values.
+    """
+
+    header: List[str]
+    particles_a: np.ndarray
+    particles_b: np.ndarray
+    vertices_a: np.ndarray
+    vertices_b: np.ndarray
+    attributes: List[str]
+
+
+@dataclasses.dataclass
+class FileDiff:
+    """
+    Differences between two files a and b, which are compared event by event.
+
+    Attributes
+    ----------
+    events : dict of int to EventDiff
+        Differences of the events with the given index in the files, only events
+        which differ are included.
+    size_a, size_b : int
+        Number of events in a and b. If one file has more events, the extra events
+        are not compared.
+    """
+
+    events: Dict[int, EventDiff]
+    size_a: int
+    size_b: int
+
+    def __bool__(self) -> bool:
+        return bool(self.events) or self.size_a != self.size_b
+
+
+def diff(
+    a: Union[GenEvent, Filename],
+    b: Union[GenEvent, Filename],
+    *,
+    tolerance: float = 1e-7,
+    threads: int = 0,
+    batch_size: int = 1000,
+) -> Union[Optional[EventDiff], FileDiff]:
+    """
+    Compare two events or two files.
+
+    Unlike the equality operator, which only reports whether events are equal, this
+    returns what differs. Particles and vertices are matched in O(N log N) time by
+    sorting them, like the equality operator does.
+
+    Parameters
+    ----------
+    a, b : GenEvent or str or Path
+        Events or files to compare.
+    tolerance : float, optional
+        Absolute tolerance for momenta, positions, and weights.
+    threads : int, optional
+        Number of threads used to compare the events of files. If 0 (default), use
+        the number of hardware threads.
+    batch_size : int, optional
+        Number of events which are read from each file before they are compared.
+
+    Returns
+    -------
+    For events, None if the events are equal, otherwise :class:`EventDiff`. For files,
+    :class:`FileDiff`, which is false if the files are equal.
+    """
+    if isinstance(a, GenEvent) and isinstance(b, GenEvent):
+        d = _diff(a, b, tolerance)
+        return None if d is None else EventDiff(**d)
+    if isinstance(a, GenEvent) or isinstance(b, GenEvent):
+        raise TypeError("a and b must be both events or both files")
+
+    events: Dict[int, EventDiff] = {}
+    size_a = size_b = 0
+    with open(a) as fa, open(b) as fb:
+        ia = _batches(fa, batch_size)
+        ib = _batches(fb, batch_size)
+        while True:
+            ba = next(ia, [])
+            bb = next(ib, [])
+            for i, d in enumerate(_diff_batch(ba, bb, tolerance, threads)):
+                if d is not None:
+                    events[size_a + i] = EventDiff(**d)
+            size_a += len(ba)
+            size_b += len(bb)
+            if len(ba) < batch_size or len(bb) < batch_size:
+                break
+        # count the remaining events of the longer file
+        size_a += sum(len(x) for x in ia)
+        size_b += sum(len(x) for x in ib)
+    return FileDiff(events, size_a, size_b)
@@ -73,6 +73,255 @@ The units of cross-sections are expected to be pb.""",
         If True (default), the source indices are 1-based (Fortran, Pythia8). Set this
         to False, if the indices are 0-based (C-style).
     """,
+    "GenEvent.to_hepevt": """
+    Convert GenEvent to HEPEVT record.
+
+    This is the inverse of :meth:`from_hepevt`. The particles are stored in the
+    order of :attr:`particles`. The parents of a particle are the incoming particles
+    of its production vertex, the children are the outgoing particles of its end
+    vertex. HEPEVT stores these as ranges, so if the parents or children are not
+    contiguous, the range from the first to the last one is stored. The vertex
+    position of a particle is the position of its production vertex, or zero if it
+    has none.
+
+    Parameters
+    ----------
+    fortran : bool, optional
+        If True (default), the indices are 1-based (Fortran, Pythia8) and missing
+        parents or children are indicated by (0, 0). Otherwise, the indices are
+        0-based (C-style) and missing parents or children are indicated by (-1, -1).
+
+    Returns
+    -------
+    dict of arrays with the keys px, py, pz, en, m, pid, status, parents, children,
+    vx, vy, vz, vt. The keys match the arguments of :meth:`from_hepevt`, so the
+    event can be rebuilt with ``evt.from_hepevt(0, **d)``.
+    """,
+    "ParticlesAPI.edge_index": """
+    Particle-to-particle edges in COO form.
+
+    Array of shape (2, E). Each column holds the indices of a parent and a child
+    particle, for each pair of incoming and outgoing particle of each vertex.
+    Indices refer to the order of :attr:`GenEvent.particles`.
+    """,
+    "ParticlesAPI.attribute": """
+    Return the values of an attribute for all particles as an array.
+
+    The attribute map of the event is traversed once, no Python objects are created
+    for the values. Unparsed attributes, e.g. after reading a file, are parsed from
+    their string representation in C++ and are left unparsed in the event.
+
+    Parameters
+    ----------
+    name : str
+        Name of the attribute, e.g. "flow1".
+    dtype : dtype-like, optional
+        Numeric type of the array. Default is float64.
+    default : number or None, optional
+        Value for particles which do not have the attribute. If None (default), NaN
+        is used for floating point types and zero otherwise.
+
+    Returns
+    -------
+    Array with one value per particle, in the order of :attr:`GenEvent.particles`.
+    Raises ValueError if a value is not a number.
+    """,
+    "VerticesAPI.attribute": """
+    Return the values of an attribute for all vertices as an array.
+
+    See :meth:`ParticlesAPI.attribute`.
+    """,
+    "VerticesAPI.particles_in": """
+    Incoming particles of the vertices in CSR form.
+
+    Tuple (offsets, indices). The indices of the incoming particles of vertex i are
+    ``indices[offsets[i]:offsets[i + 1]]``. Indices refer to the order of
+    :attr:`GenEvent.particles`, vertices are in the order of :attr:`GenEvent.vertices`.
+    """,
+    "VerticesAPI.particles_out": """
+    Outgoing particles of the vertices in CSR form.
+
+    See :attr:`particles_in`.
+    """,
+    "NumpyAPI.graph": """
+    Connectivity of the event as arrays, computed in one pass over the vertices.
+
+    Returns a dict with the keys ``production_vertex`` and ``end_vertex`` (vertex
+    index per particle, -1 if there is none), ``particles_in_offsets`` and
+    ``particles_in``, ``particles_out_offsets`` and ``particles_out`` (see
+    :attr:`VerticesAPI.particles_in`), and ``edge_index`` (see
+    :attr:`ParticlesAPI.edge_index`).
+    """,
+    "graph_batch": """
+    Connectivity of many events as arrays, like :meth:`NumpyAPI.graph`.
+
+    The particles and vertices of all events are concatenated and all indices refer
+    to the concatenated arrays, like in a batched graph in PyTorch Geometric. The
+    result has the additional keys ``particle_offsets`` and ``vertex_offsets``, of
+    length M + 1 for M events. The particles of event i have the indices
+    ``particle_offsets[i]`` to ``particle_offsets[i + 1]``, and analog for vertices.
+
+    Parameters
+    ----------
+    events : iterable of GenEvent
+        Events to convert.
+    """,
+    "particles_batch": """
+    Batched version of :meth:`ParticlesAPI.to_columns`.
+
+    The columns of the particles of all events are concatenated. The events are
+    processed in parallel without holding the GIL.
+
+    Parameters
+    ----------
+    events : iterable of GenEvent
+        Events to convert.
+    fields : iterable of str or None, optional
+        Names of the columns, see :meth:`ParticlesAPI.dtypes`. If None (default), all
+        columns are returned.
+    threads : int, optional
+        Number of threads. If 0 (default), use the number of hardware threads.
+
+    Returns
+    -------
+    dict of arrays, with the additional array ``offsets`` of length M + 1 for M
+    events. The particles of event i are at the positions ``offsets[i]`` to
+    ``offsets[i + 1]``.
+    """,
+    "vertices_batch": """
+    Batched version of :meth:`VerticesAPI.to_columns`.
+
+    See :func:`particles_batch`.
+    """,
+    "GenEvent.all_attributes": """
+    Return all attributes of the event, its particles, and its vertices.
+
+    The attributes are converted in one pass over the attribute map of the event.
+    This is faster than accessing :attr:`attributes` of each particle and vertex.
+
+    Returns
+    -------
+    dict
+        Maps the attribute name to a dict, which maps the id to the value. The id is
+        0 for attributes of the event, the particle id for particle attributes, and
+        the (negative) vertex id for vertex attributes. Values are converted like in
+        :attr:`attributes`.
+    """,
+    "Reader.read_batch": """
+    Read up to n events and return their content as flat arrays.
+
+    The events are parsed in C++ without creating GenEvent objects in Python. The
+    particles and vertices of all events are concatenated into structured arrays with
+    the same fields as :attr:`GenEventData.particles` and
+    :attr:`GenEventData.vertices`. Offset arrays of length M + 1, where M is the
+    number of events read, mark the event boundaries: the particles of event i are
+    ``particles[particle_offsets[i]:particle_offsets[i + 1]]``. The offsets can be
+    passed directly to awkward.unflatten (after taking np.diff) to obtain jagged
+    arrays.
+
+    Parameters
+    ----------
+    n : int
+        Maximum number of events to read. Fewer events are returned at the end of the
+        file.
+
+    Returns
+    -------
+    dict
+        Arrays "event_number", "particles", "vertices", "weights", "links1",
+        "links2", and "particle_offsets", "vertex_offsets", "weight_offsets",
+        "link_offsets". The links use the same event-local particle ids (positive)
+        and vertex ids (negative) as :class:`GenEventData`.
+    """,
+    "ReaderAsciiParallel": """
+    Reader for HepMC3 ASCII files which parses events on several threads.
+
+    The input is split into event texts at lines that start with "E ". Batches of
+    events are parsed in parallel and returned in file order. While the events of
+    one batch are consumed, the next batch is parsed in the background.
+
+    Parameters
+    ----------
+    filename or istream : str or iostream
+        File to read.
+    threads : int, optional
+        Number of parsing threads. If 0 (default), use the number of hardware
+        threads.
+    batch_size : int, optional
+        Number of events which are parsed together. Larger batches improve the load
+        balance between threads, but need more memory.
+    """,
+    "WriterAsciiFast": """
+    Writer for HepMC3 ASCII files which is optimized for throughput.
+
+    The output is the same as that of :class:`WriterAscii` at the same precision.
+    Numbers are formatted with std::to_chars into a large buffer, which is written to
+    the file in big blocks. If pyhepmc was compiled without floating point support in
+    std::to_chars, snprintf is used, which is slower.
+
+    Parameters
+    ----------
+    filename or ostream : str or iostream
+        File to write.
+    run : GenRunInfo or None, optional
+        Run info to store in the header. If None (default), the run info of the first
+        event is used.
+    """,
+    "WriterAsciiFast.precision": """
+    Number of digits after the decimal point of floating point numbers.
+
+    The default is 16, like for :class:`WriterAscii`. Values outside of [2, 24] are
+    ignored, except 0, which selects the shortest representation that reads back to
+    the same number. This output is smaller, but no longer identical to that of
+    :class:`WriterAscii`.
+    """,
+    "WriterColumnar": """
+    Writer for the binary columnar format of pyhepmc.
+
+    Events are collected into batches. Each field of :class:`GenEventData` is
+    stored as a separate column per batch, which is compressed individually with zstd
+    or zlib if pyhepmc was compiled with one of these libraries. A footer with an
+    index of the batches allows random access. Files written on a machine with a
+    different byte order cannot be read.
+
+    Parameters
+    ----------
+    filename or ostream : str or iostream
+        File to write. Only binary-safe streams like :class:`stringstream` are
+        accepted. The other streams of pyhepmc convert line endings when reading and
+        raise TypeError.
+    run : GenRunInfo or None, optional
+        Run info to store in the header. If None (default), the run info of the first
+        event is used.
+    batch_size : int, optional
+        Number of events per batch. Larger batches compress better.
+    compression : int, optional
+        Compression level, 0 disables compression.
+    """,
+    "ReaderColumnar": """
+    Reader for the binary columnar format of pyhepmc.
+
+    See :class:`WriterColumnar` for details.
+
+    Parameters
+    ----------
+    filename or istream : str or iostream
+        File to read. The index in the footer is only used if the stream can seek.
+        Only binary-safe streams like :class:`stringstream` are accepted, see
+        :class:`WriterColumnar`.
+    """,
+    "ReaderColumnar.num_events": """
+    Return number of events in the file.
+
+    Raises RuntimeError if the file has no index, because it was not closed properly
+    or the stream cannot seek.
+    """,
+    "ReaderColumnar.seek_event": """
+    Position the reader so that the event with the given index is read next.
+
+    Raises RuntimeError if the file has no index and IndexError if the index is out of
+    range.
+    """,
     "GenEvent.weight": """Get event weight accessed by index (or the canonical/first one if there is no argument) or name.
 
     Access by weight name requires a :class:`GenRunInfo` attached to the event, otherwise this will throw an exception.
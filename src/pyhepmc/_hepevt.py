@@ -0,0 +1,137 @@
+from __future__ import annotations
+from ._core import _from_hepevt_batch, _to_hepevt_batch
+from typing import Any, Dict, Iterable, List, Optional, Union
+import numpy as np
+
+
+def from_hepevt_batch(
+    px: Any,
+    py: Any,
+    pz: Any,
+    en: Any,
+    m: Any,
+    pid: Any,
+    status: Any,
+    parents: Any = None,
+    children: Any = None,
+    vx: Any = None,
+    vy: Any = None,
+    vz: Any = None,
+    vt: Any = None,
+    *,
+    offsets: Any = None,
+    event_number: Any = None,
+    fortran: bool = True,
+    threads: int = 0,
+    writer: Any = None,
+) -> Union[List[Any], int]:
+    """
+    Convert many HEPEVT records to GenEvents in one call.
+
+    The arguments have the same meaning as in :meth:`GenEvent.from_hepevt`, but
+    contain the particles of several events. The inputs are validated once, then the
+    events are built in C++ on a thread pool without holding the GIL.
+
+    The particle arrays are either flat arrays, which contain the particles of all
+    events one after another, together with offsets, or jagged arrays from awkward
+    with one sub-list per event. Parent and child indices refer to the particles of
+    the same event, like in :meth:`GenEvent.from_hepevt`.
+
+    Parameters
+    ----------
+    px, py, pz, en, m, pid, status, parents, children, vx, vy, vz, vt : array-like
+        See :meth:`GenEvent.from_hepevt`.
+    offsets : array-like or None, optional
+        Array of length M + 1 for M events. The particles of event i are at the
+        positions ``offsets[i]`` to ``offsets[i + 1]`` in the flat arrays. If None,
+        the arrays must be awkward arrays.
+    event_number : array-like or None, optional
+        Event numbers. If None (default), events are numbered from zero.
+    fortran : bool, optional
+        See :meth:`GenEvent.from_hepevt`.
+    threads : int, optional
+        Number of threads. If 0 (default), use the number of hardware threads.
+    writer : Writer or None, optional
+        If set, write the events to this writer instead of returning them. Can be a
+        Writer or an object returned by :func:`pyhepmc.open`. A
+        :class:`pyhepmc.io.WriterAsciiFast` or :class:`pyhepmc.io.WriterHEPEVT`
+        receives the text formatted directly from the arrays, no GenEvent objects
+        are created. For WriterAsciiFast, the output is the same as if the GenEvent
+        objects were written. WriterHEPEVT writes the particles in the given order,
+        while writing a GenEvent may order them differently.
+
+    Returns
+    -------
+    List of GenEvent, or the number of written events if writer is set.
+    """
+    if offsets is None:
+        import awkward as ak
+
+        counts = ak.to_numpy(ak.num(px, axis=1))
+        offsets = np.zeros(len(counts) + 1, dtype=np.int64)
+        np.cumsum(counts, out=offsets[1:])
+
+        def flat(x: Any) -> Optional[np.ndarray]:
+            return None if x is None else ak.to_numpy(ak.flatten(x, axis=1))
+
+        px, py, pz, en, m, pid, status = (
+            flat(x) for x in (px, py, pz, en, m, pid, status)
+        )
+        parents, children, vx, vy, vz, vt = (
+            flat(x) for x in (parents, children, vx, vy, vz, vt)
+        )
+
+    if hasattr(writer, "_batch_writer"):
+        # object returned by pyhepmc.open
+        writer = writer._batch_writer()
+
+    return _from_hepevt_batch(  # type:ignore
+        offsets,
+        px,
+        py,
+        pz,
+        en,
+        m,
+        pid,
+        status,
+        parents,
+        children,
+        vx,
+        vy,
+        vz,
+        vt,
+        event_number,
+        fortran,
+        threads,
+        writer,
+    )
+
+
+def to_hepevt_batch(
+    events: Iterable[Any], *, fortran: bool = True, threads: int = 0
+) -> Dict[str, np.ndarray]:
+    """
+    Convert many GenEvents to HEPEVT records in one call.
+
+    This is the inverse of :func:`from_hepevt_batch`. The events are converted in C++
+    on a thread pool without holding the GIL, see :meth:`GenEvent.to_hepevt` for
+    details on the conversion.
+
+    Parameters
+    ----------
+    events : iterable of GenEvent
+        Events to convert.
+    fortran : bool, optional
+        See :meth:`GenEvent.to_hepevt`.
+    threads : int, optional
+        Number of threads. If 0 (default), use the number of hardware threads.
+
+    Returns
+    -------
+    dict of flat arrays with the keys of :meth:`GenEvent.to_hepevt`, which contain
+    the particles of all events one after another, and the array ``offsets`` of length
+    M + 1 for M events. The particles of event i are at the positions ``offsets[i]``
+    to ``offsets[i + 1]``. Parent and child indices refer to the particles of the same
+    event. The result can be passed to :func:`from_hepevt_batch` as keywords.
+    """
+    return _to_hepevt_batch(events, fortran, threads)  # type:ignore
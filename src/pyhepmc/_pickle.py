@@ -0,0 +1,65 @@
+"""
+Pickle support for GenEvent.
+
+Events are pickled through GenEventData. With pickle protocol 5, the arrays of
+particles, vertices, weights, and links are passed as PickleBuffer objects, which
+can be sent out-of-band without copying them. When the event is restored, each
+array is copied once into a new GenEventData.
+"""
+
+from __future__ import annotations
+from ._core import FourVector, GenEvent, GenEventData, GenRunInfo, Units
+import numpy as np
+from pickle import PickleBuffer
+from typing import Any, Optional, Tuple
+
+_ARRAYS = ("particles", "vertices", "weights", "links1", "links2")
+_LISTS = ("attribute_id", "attribute_name", "attribute_string")
+
+
+def _unpickle_event(
+    header: Tuple[int, int, int, Tuple[float, float, float, float]],
+    arrays: Tuple[Any, ...],
+    lists: Tuple[Any, ...],
+    run_info: Optional[GenRunInfo],
+) -> GenEvent:
+    ed = GenEventData()
+    number, mu, lu, pos = header
+    ed.event_number = number
+    ed.momentum_unit = Units.MomentumUnit(mu)
+    ed.length_unit = Units.LengthUnit(lu)
+    ed.event_pos = FourVector(*pos)
+    for name, buffer in zip(_ARRAYS, arrays):
+        dtype = getattr(ed, name).dtype
+        setattr(ed, name, np.frombuffer(buffer, dtype=dtype))
+    for name, value in zip(_LISTS, lists):
+        setattr(ed, name, value)
+    event = GenEvent()
+    event.read_data(ed)
+    if run_info is not None:
+        event.run_info = run_info
+    return event
+
+
+def _reduce_ex(self: GenEvent, protocol: int) -> Any:
+    ed = GenEventData()
+    self.write_data(ed)
+    pos = ed.event_pos
+    header = (
+        ed.event_number,
+        int(ed.momentum_unit),
+        int(ed.length_unit),
+        (pos.x, pos.y, pos.z, pos.t),
+    )
+    # the arrays are views on ed, which the buffers keep alive
+    arrays: Tuple[Any, ...] = tuple(getattr(ed, name) for name in _ARRAYS)
+    if protocol >= 5:
+        arrays = tuple(PickleBuffer(a) for a in arrays)
+    else:
+        arrays = tuple(a.tobytes() for a in arrays)
+    lists = tuple(getattr(ed, name) for name in _LISTS)
+    return _unpickle_event, (header, arrays, lists, self.run_info)
+
+
+def install() -> None:
+    GenEvent.__reduce_ex__ = _reduce_ex
@@ -0,0 +1,122 @@
+from __future__ import annotations
+from .io import Filename, open, shard
+from concurrent.futures import ProcessPoolExecutor
+import os
+from typing import Any, Callable, Iterable, Iterator, List, Optional, Sequence, Union
+
+
+def _batches(events: Iterable[Any], size: int) -> Iterator[List[Any]]:
+    batch = []
+    for evt in events:
+        batch.append(evt)
+        if len(batch) == size:
+            yield batch
+            batch = []
+    if batch:
+        yield batch
+
+
+def _run_shard(
+    fn: str,
+    k: int,
+    n: int,
+    func: Callable[[Any], Any],
+    reduce: Optional[Callable[[Any, Any], Any]],
+    batch_size: Optional[int],
+) -> List[Any]:
+    # returns list of results, which has at most one element if reduce is set
+    items: Iterable[Any] = shard(fn, k, n)
+    if batch_size is not None:
+        items = _batches(items, batch_size)
+    results: List[Any] = []
+    for item in items:
+        r = func(item)
+        if reduce is not None and results:
+            results[0] = reduce(results[0], r)
+        else:
+            results.append(r)
+    return results
+
+
+def _num_shards(fn: str, workers: int) -> int:
+    # files without random access are processed as one shard
+    if workers == 1:
+        return 1
+    try:
+        with open(fn) as f:
+            len(f)  # builds and caches the event index once for all workers
+    except IOError:
+        return 1
+    return workers
+
+
+def process(
+    files: Union[Filename, Sequence[Filename]],
+    func: Callable[[Any], Any],
+    workers: Optional[int] = None,
+    reduce: Optional[Callable[[Any, Any], Any]] = None,
+    batch_size: Optional[int] = None,
+) -> Any:
+    """
+    Call a function on all events of one or several files in worker processes.
+
+    Each file is split into shards with :func:`pyhepmc.io.shard`, which are
+    processed in parallel. Files which do not support random access, for example
+    compressed files, are processed as a single shard.
+
+    Parameters
+    ----------
+    files : str or Path or sequence of these
+        Files to process.
+    func : callable
+        Function which is called with each event, or with a list of events if
+        batch_size is set. Must be picklable, e.g. a function defined at module level.
+    workers : int or None, optional
+        Number of worker processes. If None (default), use the number of CPUs. If 1,
+        process the files in the calling process.
+    reduce : callable or None, optional
+        If set, combine the results of func pairwise with this function, like
+        :func:`functools.reduce`. Results are first combined in the workers, only the
+        combined results are sent back. Must be picklable.
+    batch_size : int or None, optional
+        If set, func is called with lists of up to batch_size events.
+
+    Returns
+    -------
+    If reduce is None, list of the results of func in the order of the events in the
+    files. Otherwise, the combined result, or None if there were no events.
+    """
+    if isinstance(files, (str, os.PathLike)):
+        files = [files]
+    fns = [str(fn) for fn in files]
+    if workers is None:
+        workers = os.cpu_count() or 1
+    if workers < 1:
+        raise ValueError("workers must be at least 1")
+    if batch_size is not None and batch_size < 1:
+        raise ValueError("batch_size must be at least 1")
+
+    tasks = []
+    for fn in fns:
+        n = _num_shards(fn, workers)
+        tasks += [(fn, k, n) for k in range(n)]
+
+    if workers == 1:
+        parts = [_run_shard(fn, k, n, func, reduce, batch_size) for fn, k, n in tasks]
+    else:
+        with ProcessPoolExecutor(workers) as ex:
+            futures = [
+                ex.submit(_run_shard, fn, k, n, func, reduce, batch_size)
+                for fn, k, n in tasks
+            ]
+            parts = [f.result() for f in futures]
+
+    results = [r for part in parts for r in part]
+    if reduce is None:
+        return results
+    if not results:
+        return None
+    acc = results[0]
+    for r in results[1:]:
+        acc = reduce(acc, r)
+    return acc
@@ -0,0 +1,284 @@
+from __future__ import annotations
+from ._core import FourVector, GenEvent, GenEventData, Units
+from ._pickle import _ARRAYS, _LISTS
+import multiprocessing as mp
+from multiprocessing.shared_memory import SharedMemory
+import numpy as np
+import os
+import pickle
+from typing import Any, Iterator, Optional, Union
+
+__all__ = ("EventQueue", "EventRecord")
+
+# Each slot holds one event in the layout of GenEventData: this header, followed by
+# the arrays in the order of _ARRAYS, each aligned to 8 bytes, followed by the
+# pickled attribute lists.
+_HEADER = np.dtype(
+    [
+        ("event_number", "i8"),
+        ("momentum_unit", "i4"),
+        ("length_unit", "i4"),
+        ("event_pos", "f8", (4,)),
+        ("particles", "i8"),
+        ("vertices", "i8"),
+        ("weights", "i8"),
+        ("links", "i8"),
+        ("attributes", "i8"),
+    ]
+)
+
+_DTYPES = {name: getattr(GenEventData(), name).dtype for name in _ARRAYS}
+
+
+def _aligned(n: int) -> int:
+    return (n + 7) & ~7
+
+
+class EventRecord:
+    """
+    Event in a slot of an :class:`EventQueue`.
+
+    The arrays are views on the shared memory, they have the same layout as the
+    arrays of :class:`GenEventData`. They are valid until :meth:`release` is called,
+    which returns the slot to the queue. Use :meth:`to_event` to get a
+    :class:`GenEvent` which does not depend on the slot.
+
+    Attributes
+    ----------
+    event_number : int
+        Event number.
+    momentum_unit : Units.MomentumUnit
+        Momentum unit.
+    length_unit : Units.LengthUnit
+        Length unit.
+    event_pos : FourVector
+        Event position.
+    particles, vertices, weights, links1, links2 : array
+        Views on the shared memory, same as the fields of :class:`GenEventData`.
+    attribute_id, attribute_name, attribute_string : list
+        Same as the fields of :class:`GenEventData`.
+    """
+
+    def __init__(self, queue: EventQueue, slot: int):
+        self._queue: Optional[EventQueue] = queue
+        self._slot = slot
+        buf = queue._shm.buf
+        offset = slot * queue.slot_size
+        h = np.frombuffer(buf, _HEADER, 1, offset)[0]
+        self.event_number = int(h["event_number"])
+        self.momentum_unit = Units.MomentumUnit(int(h["momentum_unit"]))
+        self.length_unit = Units.LengthUnit(int(h["length_unit"]))
+        self.event_pos = FourVector(*h["event_pos"])
+        offset += _HEADER.itemsize
+        counts = (h["particles"], h["vertices"], h["weights"], h["links"], h["links"])
+        for name, count in zip(_ARRAYS, counts):
+            a = np.frombuffer(buf, _DTYPES[name], int(count), offset)
+            setattr(self, name, a)
+            offset += _aligned(a.nbytes)
+        size = int(h["attributes"])
+        lists = pickle.loads(buf[offset : offset + size]) if size else ([], [], [])
+        for name, value in zip(_LISTS, lists):
+            setattr(self, name, value)
+
+    def to_data(self) -> GenEventData:
+        """Return a copy of the record as :class:`GenEventData`."""
+        ed = GenEventData()
+        ed.event_number = self.event_number
+        ed.momentum_unit = self.momentum_unit
+        ed.length_unit = self.length_unit
+        ed.event_pos = self.event_pos
+        for name in _ARRAYS + _LISTS:
+            setattr(ed, name, getattr(self, name))
+        return ed
+
+    def to_event(self) -> GenEvent:
+        """Return a copy of the record as :class:`GenEvent`."""
+        event = GenEvent()
+        event.read_data(self.to_data())
+        return event
+
+    def release(self) -> None:
+        """Return the slot to the queue, the arrays must not be used afterwards."""
+        if self._queue is None:
+            return
+        for name in _ARRAYS:
+            setattr(self, name, None)
+        self._queue._free.put(self._slot)
+        self._queue = None
+
+    def __enter__(self) -> EventRecord:
+        return self
+
+    def __exit__(self, *args: Any) -> None:
+        self.release()
+
+
+class EventQueue:
+    """
+    Queue which passes events between processes through shared memory.
+
+    The shared memory is split into slots of fixed size, each slot holds one event
+    in the layout of :class:`GenEventData`. Producers block in :meth:`put` while all
+    slots are in use, until consumers release them. If several processes consume
+    events, each event is delivered to exactly one of them. Only the slot index is
+    sent through a pipe, the event data is written once into shared memory and can
+    be read from there without copying it.
+
+    The queue is created in the main process and passed to the producers and
+    consumers as an argument when they are started, like
+    :class:`multiprocessing.Queue`. The process which creates the queue owns the
+    shared memory and removes it when the queue is closed.
+
+    Parameters
+    ----------
+    slots : int, optional
+        Number of events which can be in the queue at the same time.
+    slot_size : int, optional
+        Size of a slot in bytes. :meth:`put` raises ValueError for larger events.
+    ctx : multiprocessing context or None, optional
+        Context used to create the synchronization primitives. If None, use the
+        default context.
+
+    Examples
+    --------
+    ::
+
+        def analyse(queue):
+            for record in queue:
+                ...  # record.particles is a view on shared memory
+
+        with pyhepmc.EventQueue() as queue:
+            workers = [Process(target=analyse, args=(queue,)) for _ in range(4)]
+            for w in workers:
+                w.start()
+            with pyhepmc.open("events.hepmc3.gz") as f:
+                for event in f:
+                    queue.put(event)
+            queue.finish()
+            for w in workers:
+                w.join()
+    """
+
+    def __init__(
+        self, slots: int = 64, slot_size: int = 1 << 20, ctx: Optional[Any] = None
+    ):
+        if slots < 1:
+            raise ValueError("slots must be at least 1")
+        if slot_size < _HEADER.itemsize or slot_size % 8:
+            raise ValueError(
+                f"slot_size must be a multiple of 8 and at least {_HEADER.itemsize}"
+            )
+        ctx = ctx or mp.get_context()
+        self.slots = slots
+        self.slot_size = slot_size
+        self._shm = SharedMemory(create=True, size=slots * slot_size)
+        self._owner = os.getpid()
+        self._free = ctx.SimpleQueue()
+        self._filled = ctx.SimpleQueue()
+        for i in range(slots):
+            self._free.put(i)
+
+    def put(self, event: Union[GenEvent, GenEventData]) -> None:
+        """
+        Write an event into a free slot, wait if there is none.
+
+        Parameters
+        ----------
+        event : GenEvent or GenEventData
+            Event to write. The run info is not transferred.
+        """
+        if isinstance(event, GenEvent):
+            ed = GenEventData()
+            event.write_data(ed)
+        else:
+            ed = event
+        arrays = [getattr(ed, name) for name in _ARRAYS]
+        attributes = b""
+        if ed.attribute_id:
+            lists = tuple(getattr(ed, name) for name in _LISTS)
+            attributes = pickle.dumps(lists, protocol=pickle.HIGHEST_PROTOCOL)
+        size = _HEADER.itemsize + sum(_aligned(a.nbytes) for a in arrays)
+        size += len(attributes)
+        if size > self.slot_size:
+            raise ValueError(f"event needs {size} bytes, slot_size is {self.slot_size}")
+
+        slot = self._free.get()
+        buf = self._shm.buf
+        offset = slot * self.slot_size
+        h = np.frombuffer(buf, _HEADER, 1, offset)
+        pos = ed.event_pos
+        h["event_number"] = ed.event_number
+        h["momentum_unit"] = int(ed.momentum_unit)
+        h["length_unit"] = int(ed.length_unit)
+        h["event_pos"] = (pos.x, pos.y, pos.z, pos.t)
+        h["particles"] = len(ed.particles)
+        h["vertices"] = len(ed.vertices)
+        h["weights"] = len(ed.weights)
+        h["links"] = len(ed.links1)
+        h["attributes"] = len(attributes)
+        del h
+        offset += _HEADER.itemsize
+        for a in arrays:
+            np.frombuffer(buf, a.dtype, len(a), offset)[:] = a
+            offset += _aligned(a.nbytes)
+        buf[offset : offset + len(attributes)] = attributes
+        self._filled.put(slot)
+
+    def finish(self) -> None:
+        """
+        Signal that no more events follow.
+
+        Call this once after all producers are done. Consumers receive None from
+        :meth:`get` after the remaining events.
+        """
+        self._filled.put(-1)
+
+    def get(self) -> Optional[EventRecord]:
+        """
+        Wait for the next event.
+
+        Returns
+        -------
+        EventRecord, or None if :meth:`finish` was called and no events are left.
+        The record must be released when it is no longer needed.
+        """
+        slot = self._filled.get()
+        if slot < 0:
+            # put the end marker back for the other consumers
+            self._filled.put(slot)
+            return None
+        return EventRecord(self, slot)
+
+    def __iter__(self) -> Iterator[EventRecord]:
+        """Iterate over records, each record is released when the next is read."""
+        while True:
+            record = self.get()
+            if record is None:
+                return
+            try:
+                yield record
+            finally:
+                record.release()
+
+    def events(self) -> Iterator[GenEvent]:
+        """Iterate over copies of the events as :class:`GenEvent`."""
+        for record in self:
+            yield record.to_event()
+
+    def close(self) -> None:
+        """
+        Unmap the shared memory and remove it if this process created the queue.
+
+        Views on records must be deleted before.
+        """
+        if self._shm.buf is None:
+            return
+        self._shm.close()
+        if self._owner == os.getpid():
+            self._shm.unlink()
+
+    def __enter__(self) -> EventQueue:
+        return self
+
+    def __exit__(self, *args: Any) -> None:
+        self.close()
@@ -15,26 +15,46 @@ from ._core import (
     GenEvent,
     ReaderAscii as ReaderAsciiBase,
     ReaderAsciiHepMC2 as ReaderAsciiHepMC2Base,
+    ReaderAsciiParallel as ReaderAsciiParallelBase,
+    ReaderColumnar as ReaderColumnarBase,
     ReaderLHEF as ReaderLHEFBase,
     ReaderHEPEVT as ReaderHEPEVTBase,
     WriterAscii,
+    WriterAsciiFast,
     WriterAsciiHepMC2,
     WriterHEPEVT,
+    WriterColumnar,
     UnparsedAttribute,
     pyiostream,
+    decompress_iostream,
+    mmap_iostream,
+    prefetch_iostream,
+    _native_decompression,
+    _event_index,
 )
+from ._hepevt import from_hepevt_batch
+import numpy as np
 from pathlib import PurePath
-from typing import Union, Any, Optional, Callable
+import builtins
+import os
+import zipfile
+from typing import Union, Any, Optional, Callable, Dict, Tuple, Iterator
 
 __all__ = [
     "open",
+    "event_index",
+    "shard",
     "ReaderAscii",
     "ReaderAsciiHepMC2",
+    "ReaderAsciiParallel",
     "ReaderLHEF",
     "ReaderHEPEVT",
+    "ReaderColumnar",
     "WriterAscii",
+    "WriterAsciiFast",
     "WriterAsciiHepMC2",
     "WriterHEPEVT",
+    "WriterColumnar",
     "UnparsedAttribute",
 ]
 
@@ -48,6 +68,22 @@ def _exit_close(self: Any, type: Exception, value: str, tb: Any) -> bool:
     return False
 
 
+def _write_batch(self: Any, *args: Any, **kwargs: Any) -> int:
+    """
+    Write many HEPEVT records.
+
+    Accepts the same arguments as :func:`pyhepmc.from_hepevt_batch`. For
+    :class:`WriterAsciiFast` and :class:`WriterHEPEVT`, the text is formatted
+    directly from the arrays on several threads, without creating GenEvent objects.
+    Other writers convert the records to GenEvent objects in chunks first.
+
+    Returns
+    -------
+    Number of written events.
+    """
+    return from_hepevt_batch(*args, writer=self, **kwargs)  # type:ignore
+
+
 def _exit_flush(self: Any, type: Exception, value: str, tb: Any) -> bool:
     self.flush()
     return False
@@ -61,11 +97,12 @@ def _read_event_lhef_patch(self: Any, evt: GenEvent) -> bool:
 
 
 class _Iter:
-    def __init__(self, reader: Any):
+    def __init__(self, reader: Any, reuse: bool = False):
         self.reader = reader
+        self.event = GenEvent() if reuse else None
 
     def __next__(self) -> GenEvent:
-        evt = self.reader.read()
+        evt = self.reader.read(into=self.event)
         if evt is None:
             raise StopIteration
         return evt
@@ -77,13 +114,28 @@ class _Iter:
 
 
 class ReaderMixin:
-    def read(self) -> Optional[GenEvent]:
+    def read(self, into: Optional[GenEvent] = None) -> Optional[GenEvent]:
+        """
+        Read the next event.
+
+        Parameters
+        ----------
+        into : GenEvent or None, optional
+            If set, the event is read into this object, which is cleared first, and
+            returned. This saves creating a new GenEvent for every event. Particles
+            and vertices obtained from the previous content are no longer part of
+            the event afterwards.
+
+        Returns
+        -------
+        The event, or None if there are no more events.
+        """
         assert hasattr(self, "failed")
         assert hasattr(self, "read_event")
         if self.failed():
             # usually this means EOF was reached previously
             return None
-        evt = GenEvent()
+        evt = GenEvent() if into is None else into
         success = self.read_event(evt)
         # workaround for bug in HepMC3, which reports success even if
         # the next section of the file does not contain any event data
@@ -91,6 +143,18 @@ class ReaderMixin:
             success = False
         return evt if success else None
 
+    def iterate(self, reuse: bool = False) -> _Iter:
+        """
+        Iterate over the events.
+
+        Parameters
+        ----------
+        reuse : bool, optional
+            If True, every event is read into the same GenEvent object, see
+            :meth:`read`. The event is only valid until the next iteration.
+        """
+        return _Iter(self, reuse)
+
     def __iter__(self: Any) -> _Iter:
         return _Iter(self)
 
@@ -103,6 +167,18 @@ class ReaderAscii(ReaderAsciiBase, ReaderMixin):  # type:ignore
     """Reader for HepMC3 ASCII files."""
 
 
+class ReaderAsciiParallel(ReaderAsciiParallelBase, ReaderMixin):  # type:ignore
+    """Reader for HepMC3 ASCII files, which parses events on several threads."""
+
+    def read(self, into: Optional[GenEvent] = None) -> Optional[GenEvent]:
+        # events are already parsed and checked in C++, no copy needed
+        if into is None:
+            return self._read()  # type:ignore
+        # events are parsed into new objects in the worker threads, so reading
+        # into an existing event copies it
+        return into if self.read_event(into) else None  # type:ignore
+
+
 class ReaderAsciiHepMC2(ReaderAsciiHepMC2Base, ReaderMixin):  # type:ignore
     """Reader for HepMC2 ASCII files."""
 
@@ -118,25 +194,104 @@ class ReaderHEPEVT(ReaderHEPEVTBase, ReaderMixin):  # type:ignore
     """Reader for HEPEVT files."""
 
 
+class ReaderColumnar(ReaderColumnarBase, ReaderMixin):  # type:ignore
+    """Reader for the binary columnar format of pyhepmc."""
+
+
 WriterAscii.__enter__ = _enter
 WriterAscii.__exit__ = _exit_close
 WriterAscii.write = WriterAscii.write_event
+WriterAscii.write_batch = _write_batch
+
+WriterAsciiFast.__enter__ = _enter
+WriterAsciiFast.__exit__ = _exit_close
+WriterAsciiFast.write = WriterAsciiFast.write_event
+WriterAsciiFast.write_batch = _write_batch
 
 WriterAsciiHepMC2.__enter__ = _enter
 WriterAsciiHepMC2.__exit__ = _exit_close
 WriterAsciiHepMC2.write = WriterAsciiHepMC2.write_event
+WriterAsciiHepMC2.write_batch = _write_batch
 
 WriterHEPEVT.__enter__ = _enter
 WriterHEPEVT.__exit__ = _exit_close
 WriterHEPEVT.write = WriterHEPEVT.write_event
+WriterHEPEVT.write_batch = _write_batch
+
+WriterColumnar.__enter__ = _enter
+WriterColumnar.__exit__ = _exit_close
+WriterColumnar.write = WriterColumnar.write_event
+WriterColumnar.write_batch = _write_batch
 
 pyiostream.__enter__ = _enter
 pyiostream.__exit__ = _exit_flush
 
+decompress_iostream.__enter__ = _enter
+decompress_iostream.__exit__ = _exit_flush
+
+mmap_iostream.__enter__ = _enter
+mmap_iostream.__exit__ = _exit_flush
+
+prefetch_iostream.__enter__ = _enter
+prefetch_iostream.__exit__ = _exit_close
+
 
 Filename = Union[str, PurePath]
 
 
+def event_index(
+    filename: Filename, cache: bool = True
+) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Return byte offsets and event numbers of all events in an ASCII file.
+
+    The offsets point to the lines which start with "E ", which begin an event in
+    HepMC3 and HepMC2 ASCII files. The file must not be compressed. The file is only
+    scanned for these lines and not parsed, which is much faster than reading it.
+
+    Parameters
+    ----------
+    filename : str or Path
+        File to index.
+    cache : bool, optional
+        If True (default), store the index in a sidecar file with the suffix
+        ".idx.npz" appended to the file name, and reuse it as long as size and
+        modification time of the file do not change.
+
+    Returns
+    -------
+    offsets, event_numbers : (ndarray, ndarray)
+    """
+    fn = str(filename)
+    stat = os.stat(fn)
+    index_fn = fn + ".idx.npz"
+    if cache:
+        try:
+            with np.load(index_fn) as d:
+                if d["size"] == stat.st_size and d["mtime_ns"] == stat.st_mtime_ns:
+                    return d["offsets"], d["event_numbers"]
+        except (OSError, KeyError, ValueError, zipfile.BadZipFile):
+            pass
+    offsets, event_numbers = _event_index(fn)
+    if cache:
+        # write to temporary file and rename, since several processes
+        # may build the index at the same time, see shard
+        tmp_fn = f"{index_fn}.{os.getpid()}"
+        try:
+            with builtins.open(tmp_fn, "wb") as f:
+                np.savez(
+                    f,
+                    offsets=offsets,
+                    event_numbers=event_numbers,
+                    size=stat.st_size,
+                    mtime_ns=stat.st_mtime_ns,
+                )
+            os.replace(tmp_fn, index_fn)
+        except OSError:
+            pass  # directory is not writeable, index is just not cached
+    return offsets, event_numbers
+
+
 class _WrappedWriter:
     # Wrapper for Writer, to be used by `open`
 
@@ -162,21 +317,23 @@ class _WrappedWriter:
             "convertible to it by providing a to_hepmc3() method"
         )
 
-    def write(self, event: Any) -> None:
-        evt = self._maybe_convert(event)
-
+    def writer(self, run_info: Any = None) -> Any:
         if self._writer is None:
             # first call
             iostream, precision, Writer = self._init
             if Writer is WriterHEPEVT:
                 self._writer = Writer(iostream)
             else:
-                self._writer = Writer(iostream, evt.run_info)
+                self._writer = Writer(iostream, run_info)
             if precision is not None and hasattr(self._writer, "precision"):
                 self._writer.precision = precision
+        return self._writer
 
-        self._writer.write_event(evt)
-        if self._writer.failed():
+    def write(self, event: Any) -> None:
+        evt = self._maybe_convert(event)
+        writer = self.writer(evt.run_info)
+        writer.write_event(evt)
+        if writer.failed():
             raise IOError("writing GenEvent failed")
 
     def close(self) -> None:
@@ -197,7 +354,10 @@ class HepMCFile:
         Filename to open for reading or writing or file object. When writing to
         existing files, the contents are replaced. When the filename ends with the
         suffixes ".gz", ".bz2", ".xz", ".zst" or ".zstd",
-        the contents are transparently compressed and decompressed.
+        the contents are transparently compressed and decompressed. If pyhepmc was
+        compiled with zlib or zstd, ".gz" and ".zst" files are decompressed in C++
+        when reading, which is faster and does not hold the GIL. Uncompressed local
+        files are memory-mapped when reading, see the mmap parameter.
     mode : str, optional
         Must be either "r" (default) or "w", to indicate whether to open for reading
         or writing.
@@ -207,8 +367,26 @@ class HepMCFile:
     format : str or None, optional
         Which format to use for reading or writing. If None (default), autodetect
         format when reading (this is fast and thus safe to use), and use the latest
-        HepMC3 format when writing. Allowed values (case-insensitive): "HepMC3",
-        "HepMC2", "LHEF", "HEPEVT". "LHEF" is not supported for writing.
+        HepMC3 format when writing, which is written with :class:`WriterAsciiFast`. Allowed values (case-insensitive): "HepMC3",
+        "HepMC2", "LHEF", "HEPEVT", "columnar". "LHEF" is not supported for writing.
+        "columnar" is the binary format of :class:`WriterColumnar`, which can only be
+        used with uncompressed files.
+    prefetch : bool or (int, int), optional
+        If True, read ahead in a background thread while the current event is
+        parsed, which hides read and decompression latency. Pass a tuple
+        (number of buffers, buffer size in bytes) to configure the read-ahead
+        buffers, the default is (4, 1 MiB). Only supported for reading text formats.
+    threads : int or None, optional
+        If not None, parse HepMC3 ASCII files with :class:`ReaderAsciiParallel` using
+        this many threads, 0 selects the number of hardware threads. Only supported
+        for reading HepMC3 ASCII files.
+    mmap : bool, optional
+        If True (default), uncompressed local files are memory-mapped when reading,
+        which avoids copies and enables random access, see :meth:`seek_event`. The
+        mapping covers the file as it was when it was opened: data appended later is
+        not seen, and if the file is truncated while it is mapped, reading the
+        removed part terminates the process with SIGBUS. Pass False to read through
+        a regular file object instead, e.g. for files which are still being written.
 
     Raises
     ------
@@ -216,7 +394,7 @@ class HepMCFile:
     """
 
     _reader: Optional[ReaderMixin]
-    _writer: Optional[Union[WriterAscii, WriterAsciiHepMC2, WriterHEPEVT]]
+    _writer: Optional[_WrappedWriter]
 
     def __init__(
         self,
@@ -224,8 +402,17 @@ class HepMCFile:
         mode: str = "r",
         precision: Optional[int] = None,
         format: Optional[str] = None,
+        prefetch: Union[bool, Tuple[int, int]] = False,
+        threads: Optional[int] = None,
+        mmap: bool = True,
     ):
         open_file: Optional[Callable[[], Any]] = None
+        open_ios: Optional[Callable[[], Any]] = None
+        self._index_fn: Optional[str] = None
+        self._offsets: Optional[np.ndarray] = None
+        self._header_parsed = False
+        # name of uncompressed file, required by the columnar format
+        plain_fn: Optional[str] = None
         if hasattr(fileobj, "read") and hasattr(fileobj, "write"):
             if hasattr(fileobj, "buffer"):
                 self._file = fileobj.buffer
@@ -235,7 +422,10 @@ class HepMCFile:
         else:
             fn = str(fileobj)
 
-            if fn.endswith(".gz"):
+            if mode.startswith("r") and fn.endswith(_native_decompression):
+                # decompress in C++ without going through a Python file object
+                open_ios = lambda: decompress_iostream(fn)
+            elif fn.endswith(".gz"):
                 import gzip
 
                 open = gzip.open
@@ -261,25 +451,45 @@ class HepMCFile:
                 from builtins import open  # type:ignore
 
                 mode += "b"
+                plain_fn = fn
+                if (
+                    mmap
+                    and mode == "rb"
+                    and os.path.isfile(fn)
+                    and os.access(fn, os.R_OK)
+                ):
+                    # parse directly from the mapped pages, without copies
+                    open_ios = lambda: mmap_iostream(fn)
 
-            open_file = lambda: open(fn, mode)
+            if open_ios is None:
+                open_file = lambda: open(fn, mode)
 
-            self._close_file = True
+            self._close_file = open_ios is None
 
         if mode.startswith("r"):
-            if open_file:
-                self._file = open_file()
-            self._ios = pyiostream(self._file)
+            if open_ios:
+                self._file = None
+                self._ios = open_ios()
+            else:
+                if open_file:
+                    self._file = open_file()
+                self._ios = pyiostream(self._file)
 
             Reader: Optional[Any] = None
             if format is None:
                 # auto-detect
-                if not self._file.seekable():
-                    raise ValueError("cannot detect format, file is not seekable")
-                header = self._file.read(256)
+                if open_ios:
+                    # read header from separate stream, C++ streams cannot rewind
+                    header = open_ios().read(256)
+                else:
+                    if not self._file.seekable():
+                        raise ValueError("cannot detect format, file is not seekable")
+                    header = self._file.read(256)
+                    self._file.seek(0)
                 assert isinstance(header, bytes)  # for mypy
-                self._file.seek(0)
-                if b"HepMC::Asciiv3" in header:
+                if header.startswith(b"PYHEPMCC"):
+                    Reader = ReaderColumnar
+                elif b"HepMC::Asciiv3" in header:
                     Reader = ReaderAscii
                 elif b"HepMC::IO_GenEvent" in header:
                     Reader = ReaderAsciiHepMC2
@@ -294,24 +504,58 @@ class HepMCFile:
                     "hepmc2": ReaderAsciiHepMC2,
                     "lhef": ReaderLHEF,
                     "hepevt": ReaderHEPEVT,
+                    "columnar": ReaderColumnar,
                 }.get(format.lower(), None)
                 if Reader is None:
                     raise ValueError(f"format {format!r} not recognized for reading")
 
-            self._reader = Reader(self._ios)
+            if threads is not None and Reader is not ReaderAscii:
+                raise ValueError("threads is only supported for HepMC3 ASCII files")
+
+            if Reader is ReaderColumnar:
+                # binary format, must bypass the line ending conversion of the streams
+                if plain_fn is None:
+                    raise ValueError("columnar format requires name of uncompressed file")
+                if prefetch:
+                    raise ValueError("prefetch is not supported for columnar files")
+                self._reader = ReaderColumnar(plain_fn)
+            else:
+                # only wrap the stream which the reader consumes
+                if prefetch:
+                    nbuffers, size = (4, 1 << 20) if prefetch is True else prefetch
+                    self._ios = prefetch_iostream(self._ios, nbuffers, size)
+                if threads is not None:
+                    self._reader = ReaderAsciiParallel(self._ios, threads)
+                else:
+                    self._reader = Reader(self._ios)
             self._writer = None
 
+            # random access to events in uncompressed ASCII files, see seek_event
+            if (
+                plain_fn is not None
+                and isinstance(self._ios, mmap_iostream)
+                and type(self._reader) in (ReaderAscii, ReaderAsciiHepMC2)
+            ):
+                self._index_fn = plain_fn
+
         elif mode.startswith("w"):
+            if prefetch:
+                raise ValueError("prefetch is only supported for reading")
+            if threads is not None:
+                raise ValueError("threads is only supported for reading")
             if format is None:
-                Writer = WriterAscii
+                Writer = WriterAsciiFast
             else:
                 Writer = {
-                    "hepmc3": WriterAscii,
+                    "hepmc3": WriterAsciiFast,
                     "hepmc2": WriterAsciiHepMC2,
                     "hepevt": WriterHEPEVT,
+                    "columnar": WriterColumnar,
                 }.get(format.lower(), None)
                 if Writer is None:
                     raise ValueError(f"format {format!r} not recognized for writing")
+                if Writer is WriterColumnar and plain_fn is None:
+                    raise ValueError("columnar format requires name of uncompressed file")
 
             if open_file:
                 self._file = open_file()
@@ -328,27 +572,121 @@ class HepMCFile:
         assert self._reader is not None
         return self._reader.__iter__()
 
+    def iterate(self, reuse: bool = False) -> Any:
+        """
+        Iterate over the events, see :meth:`ReaderAscii.iterate`.
+        """
+        if not self._reader:
+            raise IOError("File openened for writing")
+        return self._reader.iterate(reuse)
+
     def flush(self) -> None:
         if not self._writer:
             raise IOError("File opened for reading")
         self._ios.flush()
         self._file.flush()
 
-    def read(self) -> GenEvent:
+    def read(self, into: Optional[GenEvent] = None) -> GenEvent:
         if not self._reader:
             raise IOError("File openened for writing")
-        return self._reader.read()
+        return self._reader.read(into)
+
+    def seek_event(self, index: int) -> None:
+        """
+        Position the file so that the event with the given index is read next.
+
+        Supported when reading uncompressed HepMC3 and HepMC2 ASCII files with mmap
+        enabled and files in the columnar format. For ASCII files, the byte offsets of the events are
+        computed on first use with :func:`event_index` and cached in a sidecar file.
+        """
+        if isinstance(self._reader, ReaderColumnar):
+            self._reader.seek_event(index)
+            return
+        offsets = self._event_offsets()
+        if not 0 <= index < len(offsets):
+            raise IndexError("event index out of range")
+        if not self._header_parsed:
+            # the reader parses the run info in the header with the first event
+            self._ios.seekg(0)
+            self._reader.read()  # type:ignore
+            self._header_parsed = True
+        self._ios.seekg(int(offsets[index]))
+
+    def _event_offsets(self) -> np.ndarray:
+        if self._offsets is None:
+            if self._index_fn is None:
+                raise IOError(
+                    "random access requires reading an uncompressed HepMC3 or HepMC2 "
+                    "file with mmap and without prefetch or threads, or a file in "
+                    "columnar format"
+                )
+            self._offsets = event_index(self._index_fn)[0]
+        return self._offsets
+
+    def _shard_range(self, k: int, n: int) -> Tuple[int, int]:
+        # indices of the events in shard k of n; shards of ASCII files are byte
+        # ranges of equal size, which are moved to the next event boundary
+        if isinstance(self._reader, ReaderColumnar):
+            size = len(self)
+            return k * size // n, (k + 1) * size // n
+        offsets = self._event_offsets()
+        assert self._index_fn is not None  # for mypy
+        size = os.path.getsize(self._index_fn)
+        begin, end = np.searchsorted(offsets, [k * size // n, (k + 1) * size // n])
+        return int(begin), int(end)
+
+    def __len__(self) -> int:
+        if isinstance(self._reader, ReaderColumnar):
+            return self._reader.num_events()  # type:ignore
+        return len(self._event_offsets())
+
+    def __getitem__(self, key: Union[int, slice]) -> Any:
+        if isinstance(key, slice):
+            return [self[i] for i in range(*key.indices(len(self)))]
+        if key < 0:
+            key += len(self)
+        self.seek_event(key)
+        return self.read()
+
+    def read_batch(self, n: int) -> Dict[str, Any]:
+        """
+        Read up to n events into flat arrays.
+
+        See :meth:`ReaderAscii.read_batch` for details.
+        """
+        if not self._reader:
+            raise IOError("File openened for writing")
+        return self._reader.read_batch(n)  # type:ignore
 
     def write(self, event: GenEvent) -> None:
         if not self._writer:
             raise IOError("File openened for reading")
         self._writer.write(event)
 
+    def write_batch(self, *args: Any, **kwargs: Any) -> int:
+        """
+        Write many HEPEVT records.
+
+        Accepts the same arguments as :func:`pyhepmc.from_hepevt_batch`. HepMC3 and
+        HEPEVT output is formatted directly from the arrays, without creating GenEvent
+        objects.
+        """
+        return from_hepevt_batch(*args, writer=self, **kwargs)  # type:ignore
+
+    def _batch_writer(self) -> Any:
+        # used by from_hepevt_batch to write to the underlying Writer directly
+        if not self._writer:
+            raise IOError("File openened for reading")
+        return self._writer.writer()
+
     def close(self) -> None:
         if self._reader:
             self._reader.close()  # type:ignore
         if self._writer:
             self._writer.close()
+        if isinstance(self._ios, prefetch_iostream):
+            # background thread must stop before the file is closed
+            self._ios.close()
         self._ios.flush()
         if self._close_file:
             self._file.close()
@@ -359,10 +697,47 @@ def open(
     mode: str = "r",
     precision: Optional[int] = None,
     format: Optional[str] = None,
+    prefetch: Union[bool, Tuple[int, int]] = False,
+    threads: Optional[int] = None,
+    mmap: bool = True,
 ) -> Any:
     """
     Open HepMC files for reading or writing.
 
     See HepMCFile.
     """
-    return HepMCFile(fileobj, mode, precision, format)
+    return HepMCFile(fileobj, mode, precision, format, prefetch, threads, mmap)
+
+
+def shard(fileobj: Filename, k: int, n: int) -> Iterator[GenEvent]:
+    """
+    Iterate over the events in shard k of n of a file.
+
+    The file is split into n byte ranges of equal size, which begin on event
+    boundaries. Each event belongs to exactly one shard. Only the events of the
+    shard are parsed, see :meth:`HepMCFile.seek_event` for the supported files.
+    With n = 1, any file can be read.
+
+    Parameters
+    ----------
+    fileobj : str or Path
+        File to read.
+    k : int
+        Index of the shard, from 0 to n - 1.
+    n : int
+        Number of shards.
+    """
+    if not 0 <= k < n:
+        raise ValueError("k must be in the range [0, n)")
+    with open(fileobj) as f:
+        if n == 1:
+            yield from f
+            return
+        begin, end = f._shard_range(k, n)
+        if begin < end:
+            f.seek_event(begin)
+        for _ in range(begin, end):
+            evt = f.read()
+            if evt is None:
+                break
+            yield evt
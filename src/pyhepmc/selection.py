@@ -0,0 +1,232 @@
+"""
+Particle selections which are evaluated in C++.
+
+Selections are built from the field objects in this module with the usual
+arithmetic and comparison operators, and combined with ``&``, ``|``, and ``~``.
+The expression is compiled once into a program for a small stack machine in C++,
+which is then evaluated for each particle without calling back into Python.
+
+Since ``&`` and ``|`` bind more strongly than comparisons in Python, comparisons
+must be put into parentheses.
+
+Examples
+--------
+>>> from pyhepmc.selection import Select, pid, status, pt, e
+>>> protons = Select((abs(pid) == 2212) & (status == 1) & (pt > 1.0))
+>>> protons.count(evt)  # number of selected particles in the event
+>>> protons.sum(evt, e)  # energy sum of the selected particles
+>>> protons.count(events)  # array with the counts for each event
+"""
+
+from __future__ import annotations
+from ._core import SelectBase
+from typing import Any, List, Tuple, Union
+
+__all__ = (
+    "Select",
+    "Expr",
+    "id",
+    "pid",
+    "status",
+    "generated_mass",
+    "px",
+    "py",
+    "pz",
+    "e",
+    "pt",
+    "eta",
+    "phi",
+    "rap",
+    "m",
+    "p3mod",
+)
+
+_Program = List[Tuple[str, Any]]
+
+
+class Expr:
+    """
+    Expression on the fields of a particle.
+
+    Expressions are created from the field objects of this module, for example
+    ``pt * 2 > e``. They are not evaluated in Python, see :class:`Select`.
+    """
+
+    __slots__ = ("_program",)
+
+    def __init__(self, program: _Program):
+        self._program = program
+
+    def __repr__(self) -> str:
+        return f"Expr({self._program!r})"
+
+    def __bool__(self) -> bool:
+        raise TypeError(
+            "Expr cannot be converted to bool, use & | ~ instead of and or not "
+            "and put comparisons into parentheses"
+        )
+
+    def _unary(self, op: str) -> Expr:
+        return Expr(self._program + [(op, None)])
+
+    def _binary(self, other: Any, op: str, reverse: bool = False) -> Expr:
+        a = self._program
+        b = _as_expr(other)._program
+        if reverse:
+            a, b = b, a
+        return Expr(a + b + [(op, None)])
+
+    def __abs__(self) -> Expr:
+        return self._unary("abs")
+
+    def __neg__(self) -> Expr:
+        return self._unary("neg")
+
+    def __invert__(self) -> Expr:
+        return self._unary("not")
+
+    def __add__(self, other: Any) -> Expr:
+        return self._binary(other, "add")
+
+    def __radd__(self, other: Any) -> Expr:
+        return self._binary(other, "add", True)
+
+    def __sub__(self, other: Any) -> Expr:
+        return self._binary(other, "sub")
+
+    def __rsub__(self, other: Any) -> Expr:
+        return self._binary(other, "sub", True)
+
+    def __mul__(self, other: Any) -> Expr:
+        return self._binary(other, "mul")
+
+    def __rmul__(self, other: Any) -> Expr:
+        return self._binary(other, "mul", True)
+
+    def __truediv__(self, other: Any) -> Expr:
+        return self._binary(other, "div")
+
+    def __rtruediv__(self, other: Any) -> Expr:
+        return self._binary(other, "div", True)
+
+    def __lt__(self, other: Any) -> Expr:
+        return self._binary(other, "lt")
+
+    def __le__(self, other: Any) -> Expr:
+        return self._binary(other, "le")
+
+    def __gt__(self, other: Any) -> Expr:
+        return self._binary(other, "gt")
+
+    def __ge__(self, other: Any) -> Expr:
+        return self._binary(other, "ge")
+
+    def __eq__(self, other: Any) -> Expr:  # type:ignore
+        return self._binary(other, "eq")
+
+    def __ne__(self, other: Any) -> Expr:  # type:ignore
+        return self._binary(other, "ne")
+
+    def __and__(self, other: Any) -> Expr:
+        return self._binary(other, "and")
+
+    def __rand__(self, other: Any) -> Expr:
+        return self._binary(other, "and", True)
+
+    def __or__(self, other: Any) -> Expr:
+        return self._binary(other, "or")
+
+    def __ror__(self, other: Any) -> Expr:
+        return self._binary(other, "or", True)
+
+    __hash__ = None  # type:ignore
+
+
+def _as_expr(x: Any) -> Expr:
+    if isinstance(x, Expr):
+        return x
+    if isinstance(x, str):
+        return Expr([("field", x)])
+    return Expr([("const", float(x))])
+
+
+id = Expr([("field", "id")])
+pid = Expr([("field", "pid")])
+status = Expr([("field", "status")])
+generated_mass = Expr([("field", "generated_mass")])
+px = Expr([("field", "px")])
+py = Expr([("field", "py")])
+pz = Expr([("field", "pz")])
+e = Expr([("field", "e")])
+pt = Expr([("field", "pt")])
+eta = Expr([("field", "eta")])
+phi = Expr([("field", "phi")])
+rap = Expr([("field", "rap")])
+m = Expr([("field", "m")])
+p3mod = Expr([("field", "p3mod")])
+
+
+class Select(SelectBase):
+    """
+    Particle selection compiled from an expression.
+
+    All methods accept either a single GenEvent or an iterable of GenEvent. For a
+    single event, they return a result for this event. For several events, they
+    return an array with one result per event, which are computed in parallel
+    without holding the GIL.
+
+    Parameters
+    ----------
+    expr : Expr
+        Expression which is true for selected particles, e.g.
+        ``(abs(pid) == 2212) & (pt > 1)``.
+    threads : int, optional
+        Number of threads used for several events. If 0 (default), use the number
+        of hardware threads.
+    """
+
+    def __init__(self, expr: Expr, threads: int = 0):
+        super().__init__(_as_expr(expr)._program)
+        self._threads = threads
+
+    def mask(self, events: Any) -> Any:
+        """
+        Return boolean mask of the selected particles.
+
+        For several events, the masks are concatenated, like the columns returned
+        by :func:`pyhepmc.particles_batch`.
+        """
+        return self._mask(events, self._threads)
+
+    def count(self, events: Any) -> Any:
+        """Return the number of selected particles."""
+        return self._count(events, self._threads)
+
+    def sum(self, events: Any, value: Union[Expr, str]) -> Any:
+        """
+        Return the sum of an expression over the selected particles.
+
+        Parameters
+        ----------
+        events : GenEvent or iterable of GenEvent
+            Input.
+        value : Expr or str
+            Expression or field name, e.g. ``e`` or ``"e"``.
+        """
+        return self._reduce(events, "sum", _as_expr(value)._program, self._threads)
+
+    def min(self, events: Any, value: Union[Expr, str]) -> Any:
+        """
+        Return the minimum of an expression over the selected particles.
+
+        The result is NaN if no particle is selected. See :meth:`sum`.
+        """
+        return self._reduce(events, "min", _as_expr(value)._program, self._threads)
+
+    def max(self, events: Any, value: Union[Expr, str]) -> Any:
+        """
+        Return the maximum of an expression over the selected particles.
+
+        The result is NaN if no particle is selected. See :meth:`sum`.
+        """
+        return self._reduce(events, "max", _as_expr(value)._program, self._threads)
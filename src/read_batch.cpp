@@ -0,0 +1,74 @@
+#include "geneventdata.hpp"
+#include "pybind.hpp"
+#include <HepMC3/Data/GenEventData.h>
+#include <HepMC3/GenEvent.h>
+#include <HepMC3/Reader.h>
+#include <HepMC3/ReaderLHEF.h>
+#include <cstdint>
+#include <vector>
+
+namespace HepMC3 {
+
+// same logic as ReaderMixin.read in pyhepmc/io.py
+bool read_event_checked(Reader& reader, GenEvent& event) {
+  if (reader.failed()) return false;
+  bool success = reader.read_event(event);
+  // ReaderLHEF::read_event returns true on failure, see _read_event_lhef_patch
+  if (dynamic_cast<ReaderLHEF*>(&reader)) success = !success || reader.failed();
+  // workaround for bug in HepMC3, which reports success even if
+  // the next section of the file does not contain any event data
+  return success && !event.particles().empty();
+}
+
+template <class T>
+void append(std::vector<T>& a, const std::vector<T>& b) {
+  a.insert(a.end(), b.begin(), b.end());
+}
+
+py::dict read_batch(Reader& reader, int n) {
+  if (n < 0) throw py::value_error("n must be non-negative");
+
+  std::vector<int> event_number;
+  std::vector<GenParticleData> particles;
+  std::vector<GenVertexData> vertices;
+  std::vector<double> weights;
+  std::vector<int> links1, links2;
+  std::vector<std::int64_t> particle_offsets{0}, vertex_offsets{0}, weight_offsets{0},
+      link_offsets{0};
+
+  {
+    py::gil_scoped_release release;
+    GenEvent event;
+    GenEventData data;
+    for (int i = 0; i < n; ++i) {
+      if (!read_event_checked(reader, event)) break;
+      event.write_data(data);
+      event_number.push_back(data.event_number);
+      append(particles, data.particles);
+      append(vertices, data.vertices);
+      append(weights, data.weights);
+      append(links1, data.links1);
+      append(links2, data.links2);
+      particle_offsets.push_back(particles.size());
+      vertex_offsets.push_back(vertices.size());
+      weight_offsets.push_back(weights.size());
+      link_offsets.push_back(links1.size());
+    }
+  }
+
+  py::dict result;
+  result["event_number"] = move_to_array(std::move(event_number));
+  result["particles"] =
+      move_to_array(std::move(particles), py::dtype::of<ParticleData>());
+  result["vertices"] = move_to_array(std::move(vertices), py::dtype::of<VertexData>());
+  result["weights"] = move_to_array(std::move(weights));
+  result["links1"] = move_to_array(std::move(links1));
+  result["links2"] = move_to_array(std::move(links2));
+  result["particle_offsets"] = move_to_array(std::move(particle_offsets));
+  result["vertex_offsets"] = move_to_array(std::move(vertex_offsets));
+  result["weight_offsets"] = move_to_array(std::move(weight_offsets));
+  result["link_offsets"] = move_to_array(std::move(link_offsets));
+  return result;
+}
+
+} // namespace HepMC3
@@ -0,0 +1,261 @@
+#include "reader_ascii_parallel.hpp"
+#include "parallel.hpp"
+#include <HepMC3/Data/GenEventData.h>
+#include <HepMC3/GenEvent.h>
+#include <HepMC3/ReaderAscii.h>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace HepMC3 {
+
+bool read_event_checked(Reader& reader, GenEvent& event);
+
+namespace {
+
+constexpr std::size_t block_size = 1 << 22;
+
+bool starts_with(const std::string& s, std::size_t pos, const char* prefix) {
+  return s.compare(pos, std::strlen(prefix), prefix) == 0;
+}
+
+// Returns the start of the run info lines at the end of the event text which
+// begins at s[begin], or npos. WriterAscii writes W, T, and A lines of a changed
+// run info before the next E line; after the particles and vertices of an event,
+// such lines cannot belong to the event itself.
+std::size_t run_info_tail(const std::string& s, std::size_t begin) {
+  std::size_t end = s.size();
+  std::size_t tail = std::string::npos;
+  while (end > begin) {
+    // start of the last line in [begin, end), which ends with '\n'
+    std::size_t line = begin;
+    if (end - begin >= 2) {
+      const auto k = s.rfind('\n', end - 2);
+      if (k != std::string::npos && k >= begin) line = k + 1;
+    }
+    if (starts_with(s, line, "W ") || starts_with(s, line, "T ") ||
+        starts_with(s, line, "A ")) {
+      tail = line;
+      end = line;
+      continue;
+    }
+    return starts_with(s, line, "P ") || starts_with(s, line, "V ") ? tail
+                                                                    : std::string::npos;
+  }
+  return std::string::npos;
+}
+
+} // namespace
+
+ReaderAsciiParallel::ReaderAsciiParallel(const std::string& filename, int nthreads,
+                                         int batch_size)
+    : file_(new std::ifstream(filename, std::ios::binary))
+    , stream_(file_.get())
+    , nthreads_(resolve_nthreads(nthreads))
+    , batch_size_(batch_size)
+    , pool_(nthreads_) {
+  if (!*file_) throw std::runtime_error("cannot open file " + filename);
+  if (batch_size < 1) throw std::invalid_argument("batch_size must be positive");
+  read_header();
+}
+
+ReaderAsciiParallel::ReaderAsciiParallel(std::istream& stream, int nthreads,
+                                         int batch_size)
+    : stream_(&stream)
+    , nthreads_(resolve_nthreads(nthreads))
+    , batch_size_(batch_size)
+    , pool_(nthreads_) {
+  if (batch_size < 1) throw std::invalid_argument("batch_size must be positive");
+  read_header();
+}
+
+bool ReaderAsciiParallel::read_block() {
+  if (eof_) return false;
+  // drop consumed event texts before appending new data
+  buffer_.erase(0, begin_);
+  search_ -= begin_;
+  begin_ = 0;
+  const auto size = buffer_.size();
+  buffer_.resize(size + block_size);
+  stream_->read(&buffer_[size], block_size);
+  const auto n = static_cast<std::size_t>(stream_->gcount());
+  buffer_.resize(size + n);
+  if (n == 0) eof_ = true;
+  return n > 0;
+}
+
+void ReaderAsciiParallel::read_header() {
+  // everything before the first line that starts with "E " is the header
+  while (buffer_.size() < 2 && read_block())
+    ;
+  if (buffer_.compare(0, 2, "E ") == 0) return;
+  for (;;) {
+    const auto k = buffer_.find("\nE ", search_);
+    if (k != std::string::npos) {
+      header_.assign(buffer_, 0, k + 1);
+      begin_ = search_ = k + 1;
+      break;
+    }
+    search_ = buffer_.size() < 2 ? 0 : buffer_.size() - 2;
+    if (!read_block()) {
+      header_.swap(buffer_);
+      buffer_.clear();
+      begin_ = search_ = 0;
+      break;
+    }
+  }
+  // a changed run info replaces everything after the "HepMC::" lines
+  std::size_t k = 0;
+  while (starts_with(header_, k, "HepMC::")) {
+    k = header_.find('\n', k);
+    k = k == std::string::npos ? header_.size() : k + 1;
+  }
+  preamble_.assign(header_, 0, k);
+}
+
+bool ReaderAsciiParallel::next_event_text(std::string& text) {
+  for (;;) {
+    const auto k = buffer_.find("\nE ", search_);
+    if (k != std::string::npos) {
+      text.append(buffer_, begin_, k + 1 - begin_);
+      begin_ = search_ = k + 1;
+      return true;
+    }
+    // "\nE " may straddle the block boundary
+    search_ = std::max(begin_, buffer_.size() < 2 ? 0 : buffer_.size() - 2);
+    if (!read_block()) {
+      if (begin_ == buffer_.size()) return false;
+      text.append(buffer_, begin_, std::string::npos);
+      begin_ = search_ = buffer_.size();
+      return true;
+    }
+  }
+}
+
+// Splits the next batch of events into contiguous shares, at most one per thread,
+// and starts parsing them in the background. Returns false if there are no events.
+bool ReaderAsciiParallel::start_batch() {
+  if (error_) return false;
+  shares_.clear();
+  share_headers_.clear();
+  share_sizes_.clear();
+  const int per_share = (batch_size_ + nthreads_ - 1) / nthreads_;
+  int count = per_share; // events in the current share
+  for (int i = 0; i < batch_size_; ++i) {
+    if (count == per_share) {
+      if (static_cast<int>(shares_.size()) == nthreads_) break;
+      shares_.push_back(header_);
+      share_headers_.push_back(header_);
+      share_sizes_.push_back(0);
+      count = 0;
+    }
+    auto& share = shares_.back();
+    const auto begin = share.size();
+    if (!next_event_text(share)) break;
+    ++count;
+    ++share_sizes_.back();
+    const auto tail = run_info_tail(share, begin);
+    if (tail != std::string::npos) {
+      // the run info changes, the next event starts a new share
+      header_ = preamble_;
+      header_.append(share, tail, std::string::npos);
+      share.resize(tail);
+      count = per_share;
+    }
+  }
+  if (!shares_.empty() && shares_.back().size() == share_headers_.back().size()) {
+    shares_.pop_back();
+    share_headers_.pop_back();
+    share_sizes_.pop_back();
+  }
+  if (shares_.empty()) return false;
+
+  results_.assign(shares_.size(), {});
+  pool_.submit(static_cast<int>(shares_.size()), [this](int j) {
+    std::istringstream is(shares_[j]);
+    ReaderAscii reader(is);
+    auto& result = results_[j];
+    // stop at the first failure like the serial reader; finish_batch detects it
+    // from the missing events
+    for (int i = 0; i < share_sizes_[j]; ++i) {
+      auto event = std::make_shared<GenEvent>();
+      if (!read_event_checked(reader, *event)) break;
+      result.push_back(event);
+    }
+  });
+  pending_ = true;
+  return true;
+}
+
+// Waits for the batch in the background, moves its events into the queue, and
+// starts parsing the next batch while the events are consumed. If a share has
+// an event which could not be read, the events before it are queued and the
+// following events are discarded.
+void ReaderAsciiParallel::finish_batch() {
+  pending_ = false;
+  pool_.wait();
+  auto results = std::move(results_);
+  auto headers = std::move(share_headers_);
+  auto sizes = std::move(share_sizes_);
+
+  for (std::size_t j = 0; j < results.size() && !error_; ++j) {
+    error_ = static_cast<int>(results[j].size()) < sizes[j];
+    if (results[j].empty()) continue;
+    // shares with the same header have equal run infos, which are merged into
+    // one object; a share with a new header brings a new run info
+    if (!run_info_ || headers[j] != run_info_header_) {
+      run_info_ = results[j].front()->run_info();
+      run_info_header_ = headers[j];
+      set_run_info(run_info_);
+    }
+    for (auto& event : results[j]) {
+      event->set_run_info(run_info_);
+      queue_.push_back(event);
+    }
+  }
+  start_batch();
+}
+
+void ReaderAsciiParallel::fill_queue() {
+  while (queue_.empty() && (pending_ || start_batch())) finish_batch();
+}
+
+GenEventPtr ReaderAsciiParallel::read() {
+  if (queue_.empty()) fill_queue();
+  if (queue_.empty()) {
+    failed_ = true;
+    return nullptr;
+  }
+  auto event = queue_.front();
+  queue_.pop_front();
+  return event;
+}
+
+bool ReaderAsciiParallel::read_event(GenEvent& event) {
+  auto ptr = read();
+  if (!ptr) return false;
+  GenEventData data;
+  ptr->write_data(data);
+  event.read_data(data);
+  event.set_run_info(ptr->run_info());
+  return true;
+}
+
+bool ReaderAsciiParallel::failed() { return failed_; }
+
+void ReaderAsciiParallel::close() {
+  if (pending_) {
+    pending_ = false;
+    try {
+      pool_.wait();
+    } catch (...) {}
+  }
+  queue_.clear();
+  buffer_.clear();
+  begin_ = search_ = 0;
+  eof_ = failed_ = error_ = true;
+  if (file_) file_->close();
+}
+
+} // namespace HepMC3
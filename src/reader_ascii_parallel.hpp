@@ -0,0 +1,74 @@
+#ifndef PYHEPMC_READER_ASCII_PARALLEL_HPP
+#define PYHEPMC_READER_ASCII_PARALLEL_HPP
+
+#include "parallel.hpp"
+#include "pointer.hpp"
+#include <HepMC3/Reader.h>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace HepMC3 {
+
+// Reader for HepMC3 ASCII files which parses events on several threads.
+//
+// The input is read in large blocks and split into event texts at lines
+// which start with "E ". A batch of event texts is distributed to persistent
+// worker threads, each parses its share with its own ReaderAscii. While the
+// events of one batch are consumed, the next batch is parsed. The current run
+// info header is prepended to each share, so that every worker sees the run
+// info. If the run info changes between two events, the share ends there and
+// the following shares start with the new run info. Events are returned in file
+// order. Like ReaderAscii, reading stops at the first event which cannot be read,
+// after the events before it were returned.
+class ReaderAsciiParallel : public Reader {
+  std::unique_ptr<std::ifstream> file_;
+  std::istream* stream_;
+  int nthreads_;
+  int batch_size_;
+  std::string preamble_; // "HepMC::" lines at the start of the file
+  std::string header_;   // preamble_ and the current run info lines
+  std::string buffer_;
+  std::size_t begin_ = 0;  // start of next event text in buffer_
+  std::size_t search_ = 0; // where to continue the search for the next "\nE "
+  bool eof_ = false;
+  bool failed_ = false;
+  bool error_ = false; // an event could not be read, no further batches are started
+  std::deque<GenEventPtr> queue_;
+  GenRunInfoPtr run_info_;
+  std::string run_info_header_; // header which produced run_info_
+
+  // batch which is parsed in the background
+  std::vector<std::string> shares_;
+  std::vector<std::string> share_headers_;
+  std::vector<int> share_sizes_; // number of event texts in each share
+  std::vector<std::vector<GenEventPtr>> results_;
+  bool pending_ = false;
+  // declared last, so that the workers are stopped before the shares are destroyed
+  worker_pool pool_;
+
+  bool read_block();
+  void read_header();
+  bool next_event_text(std::string& text);
+  bool start_batch();
+  void finish_batch();
+  void fill_queue();
+
+public:
+  ReaderAsciiParallel(const std::string& filename, int nthreads, int batch_size);
+  ReaderAsciiParallel(std::istream& stream, int nthreads, int batch_size);
+
+  // returns nullptr if there are no more events
+  GenEventPtr read();
+
+  bool read_event(GenEvent& event) override;
+  bool failed() override;
+  void close() override;
+};
+
+} // namespace HepMC3
+
+#endif
@@ -0,0 +1,301 @@
+#include "numpy_api.hpp"
+#include "parallel.hpp"
+#include "pybind.hpp"
+#include <HepMC3/GenEvent.h>
+#include <HepMC3/GenParticle.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace HepMC3;
+
+// A selection is compiled from a postfix program, which is produced by the
+// expression builder in pyhepmc.selection. The program is evaluated for each
+// particle on a small stack of doubles, booleans are stored as 0 and 1.
+enum class Op {
+  field,
+  constant,
+  abs,
+  neg,
+  not_,
+  add,
+  sub,
+  mul,
+  div,
+  lt,
+  le,
+  gt,
+  ge,
+  eq,
+  ne,
+  and_,
+  or_
+};
+
+using getter = double (*)(const GenParticle&);
+
+struct Instr {
+  Op op;
+  double value = 0;
+  getter get = nullptr;
+};
+
+#define FIELD(name, expr) \
+  { #name, [](const GenParticle& x) { return static_cast<double>(expr); } }
+
+const std::map<std::string, getter>& fields() {
+  static const std::map<std::string, getter> m = {
+      FIELD(id, x.id()),
+      FIELD(pid, x.pid()),
+      FIELD(status, x.status()),
+      FIELD(generated_mass, x.generated_mass()),
+      FIELD(px, x.momentum().px()),
+      FIELD(py, x.momentum().py()),
+      FIELD(pz, x.momentum().pz()),
+      FIELD(e, x.momentum().e()),
+      FIELD(pt, x.momentum().pt()),
+      FIELD(eta, x.momentum().eta()),
+      FIELD(phi, x.momentum().phi()),
+      FIELD(rap, x.momentum().rap()),
+      FIELD(m, x.momentum().m()),
+      FIELD(p3mod, x.momentum().p3mod()),
+  };
+  return m;
+}
+
+const std::map<std::string, Op>& operators() {
+  static const std::map<std::string, Op> m = {
+      {"abs", Op::abs}, {"neg", Op::neg}, {"not", Op::not_}, {"add", Op::add},
+      {"sub", Op::sub}, {"mul", Op::mul}, {"div", Op::div},  {"lt", Op::lt},
+      {"le", Op::le},   {"gt", Op::gt},   {"ge", Op::ge},    {"eq", Op::eq},
+      {"ne", Op::ne},   {"and", Op::and_}, {"or", Op::or_},
+  };
+  return m;
+}
+
+class Program {
+  static constexpr int max_depth = 32;
+  std::vector<Instr> code_;
+
+public:
+  // program is a sequence of (op, arg) tuples; arg is a field name for "field",
+  // a number for "const", and ignored otherwise
+  Program(py::sequence program) {
+    int depth = 0;
+    for (auto item : program) {
+      auto t = py::cast<py::tuple>(item);
+      const auto op = py::cast<std::string>(t[0]);
+      Instr instr;
+      if (op == "field") {
+        const auto name = py::cast<std::string>(t[1]);
+        auto it = fields().find(name);
+        if (it == fields().end()) throw py::key_error("unknown field " + name);
+        instr.op = Op::field;
+        instr.get = it->second;
+      } else if (op == "const") {
+        instr.op = Op::constant;
+        instr.value = py::cast<double>(t[1]);
+      } else {
+        auto it = operators().find(op);
+        if (it == operators().end())
+          throw py::value_error("unknown operator " + op);
+        instr.op = it->second;
+      }
+      // unary ops keep the depth, binary ops reduce it by one
+      if (instr.op == Op::field || instr.op == Op::constant)
+        ++depth;
+      else if (instr.op == Op::abs || instr.op == Op::neg || instr.op == Op::not_) {
+        if (depth < 1) throw py::value_error("invalid program");
+      } else {
+        if (depth < 2) throw py::value_error("invalid program");
+        --depth;
+      }
+      if (depth > max_depth) throw py::value_error("expression is too complex");
+      code_.push_back(instr);
+    }
+    if (depth != 1) throw py::value_error("invalid program");
+  }
+
+  double eval(const GenParticle& p) const {
+    double s[max_depth];
+    int n = 0;
+    for (const auto& i : code_) {
+      switch (i.op) {
+        case Op::field: s[n++] = i.get(p); break;
+        case Op::constant: s[n++] = i.value; break;
+        case Op::abs: s[n - 1] = std::abs(s[n - 1]); break;
+        case Op::neg: s[n - 1] = -s[n - 1]; break;
+        case Op::not_: s[n - 1] = !s[n - 1]; break;
+        default: {
+          const double b = s[--n];
+          double& a = s[n - 1];
+          switch (i.op) {
+            case Op::add: a += b; break;
+            case Op::sub: a -= b; break;
+            case Op::mul: a *= b; break;
+            case Op::div: a /= b; break;
+            case Op::lt: a = a < b; break;
+            case Op::le: a = a <= b; break;
+            case Op::gt: a = a > b; break;
+            case Op::ge: a = a >= b; break;
+            case Op::eq: a = a == b; break;
+            case Op::ne: a = a != b; break;
+            case Op::and_: a = a && b; break;
+            case Op::or_: a = a || b; break;
+            default: break;
+          }
+        }
+      }
+    }
+    return s[0];
+  }
+};
+
+struct Reduction {
+  double sum = 0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+  std::int64_t count = 0;
+
+  double get(char kind) const {
+    if (kind == 's') return sum;
+    if (count == 0) return std::numeric_limits<double>::quiet_NaN();
+    return kind == '<' ? min : max;
+  }
+};
+
+char reduction_kind(const std::string& kind) {
+  if (kind == "sum") return 's';
+  if (kind == "min") return '<';
+  if (kind == "max") return '>';
+  throw py::value_error("kind must be sum, min, or max");
+}
+
+class Selection {
+  Program cut_;
+
+  // calls f with each selected particle
+  template <class F>
+  void select(const GenEvent& event, F&& f) const {
+    for (const auto& p : event.particles())
+      if (cut_.eval(*p)) f(*p);
+  }
+
+public:
+  Selection(py::sequence cut) : cut_(cut) {}
+
+  py::object mask(py::object events, int threads) const {
+    if (py::isinstance<GenEvent>(events)) {
+      const auto& event = py::cast<const GenEvent&>(events);
+      const auto& particles = event.particles();
+      py::array_t<bool> result(particles.size());
+      auto out = result.mutable_data();
+      {
+        py::gil_scoped_release release;
+        for (std::size_t i = 0; i < particles.size(); ++i)
+          out[i] = cut_.eval(*particles[i]);
+      }
+      return std::move(result);
+    }
+    std::vector<py::object> keep;
+    const auto pevents = collect_events(events, keep);
+    const int nevent = pevents.size();
+    std::vector<std::int64_t> offsets(nevent + 1, 0);
+    for (int i = 0; i < nevent; ++i)
+      offsets[i + 1] = offsets[i] + pevents[i]->particles().size();
+    py::array_t<bool> result(offsets.back());
+    auto out = result.mutable_data();
+    {
+      py::gil_scoped_release release;
+      parallel_for(nevent, threads, [&](int i) {
+        const auto& particles = pevents[i]->particles();
+        for (std::size_t j = 0; j < particles.size(); ++j)
+          out[offsets[i] + j] = cut_.eval(*particles[j]);
+      });
+    }
+    return std::move(result);
+  }
+
+  py::object count(py::object events, int threads) const {
+    auto count1 = [this](const GenEvent& event) {
+      std::int64_t n = 0;
+      select(event, [&n](const GenParticle&) { ++n; });
+      return n;
+    };
+    if (py::isinstance<GenEvent>(events)) {
+      const auto& event = py::cast<const GenEvent&>(events);
+      std::int64_t n;
+      {
+        py::gil_scoped_release release;
+        n = count1(event);
+      }
+      return py::int_(n);
+    }
+    std::vector<py::object> keep;
+    const auto pevents = collect_events(events, keep);
+    const int nevent = pevents.size();
+    py::array_t<std::int64_t> result(nevent);
+    auto out = result.mutable_data();
+    {
+      py::gil_scoped_release release;
+      parallel_for(nevent, threads,
+                   [&](int i) { out[i] = count1(*pevents[i]); });
+    }
+    return std::move(result);
+  }
+
+  py::object reduce(py::object events, const std::string& skind, py::sequence value,
+                    int threads) const {
+    const char kind = reduction_kind(skind);
+    const Program prog(value);
+    auto reduce1 = [this, &prog, kind](const GenEvent& event) {
+      Reduction r;
+      select(event, [&r, &prog](const GenParticle& p) {
+        const double x = prog.eval(p);
+        r.sum += x;
+        r.min = std::min(r.min, x);
+        r.max = std::max(r.max, x);
+        ++r.count;
+      });
+      return r.get(kind);
+    };
+    if (py::isinstance<GenEvent>(events)) {
+      const auto& event = py::cast<const GenEvent&>(events);
+      double x;
+      {
+        py::gil_scoped_release release;
+        x = reduce1(event);
+      }
+      return py::float_(x);
+    }
+    std::vector<py::object> keep;
+    const auto pevents = collect_events(events, keep);
+    const int nevent = pevents.size();
+    py::array_t<double> result(nevent);
+    auto out = result.mutable_data();
+    {
+      py::gil_scoped_release release;
+      parallel_for(nevent, threads,
+                   [&](int i) { out[i] = reduce1(*pevents[i]); });
+    }
+    return std::move(result);
+  }
+};
+
+} // namespace
+
+void register_selection(py::module& m) {
+  py::class_<Selection>(m, "SelectBase")
+      .def(py::init<py::sequence>(), "program"_a)
+      .def("_mask", &Selection::mask, "events"_a, "threads"_a = 0)
+      .def("_count", &Selection::count, "events"_a, "threads"_a = 0)
+      .def("_reduce", &Selection::reduce, "events"_a, "kind"_a, "value"_a,
+           "threads"_a = 0);
+}
@@ -0,0 +1,161 @@
+#include "numpy_api.hpp"
+#include "parallel.hpp"
+#include "pybind.hpp"
+#include <HepMC3/GenEvent.h>
+#include <HepMC3/GenParticle.h>
+#include <HepMC3/GenVertex.h>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace HepMC3 {
+
+namespace {
+
+// Raw pointers into the output arrays, which hold the particles of one or
+// several events. Filling them does not touch Python objects, so it can run
+// without the GIL.
+struct hepevt_output {
+  double *px, *py, *pz, *en, *m;
+  int *pid, *status;
+  int *parents, *children; // shape (n, 2)
+  double *vx, *vy, *vz, *vt;
+};
+
+// Allocates the output arrays for n particles and returns them as a dict with the
+// keyword names of GenEvent.from_hepevt.
+py::dict make_hepevt_output(py::ssize_t n, hepevt_output& out) {
+  auto darray = [n](double*& p) {
+    py::array_t<double> a(n);
+    p = a.mutable_data();
+    return a;
+  };
+  auto iarray = [n](int*& p) {
+    py::array_t<int> a(n);
+    p = a.mutable_data();
+    return a;
+  };
+  auto rarray = [n](int*& p) {
+    py::array_t<int> a({n, static_cast<py::ssize_t>(2)});
+    p = a.mutable_data();
+    return a;
+  };
+  py::dict result;
+  result["px"] = darray(out.px);
+  result["py"] = darray(out.py);
+  result["pz"] = darray(out.pz);
+  result["en"] = darray(out.en);
+  result["m"] = darray(out.m);
+  result["pid"] = iarray(out.pid);
+  result["status"] = iarray(out.status);
+  result["parents"] = rarray(out.parents);
+  result["children"] = rarray(out.children);
+  result["vx"] = darray(out.vx);
+  result["vy"] = darray(out.vy);
+  result["vz"] = darray(out.vz);
+  result["vt"] = darray(out.vt);
+  return result;
+}
+
+// Smallest and largest id of the particles, or (0, 0) if there are none. Ids
+// start at one, so the result is already a Fortran-style range.
+std::pair<int, int> id_range(const std::vector<ConstGenParticlePtr>& particles) {
+  if (particles.empty()) return {0, 0};
+  int lo = particles.front()->id();
+  int hi = lo;
+  for (const auto& p : particles) {
+    lo = std::min(lo, p->id());
+    hi = std::max(hi, p->id());
+  }
+  return {lo, hi};
+}
+
+// Writes the particles of the event to the output arrays, starting at offset. The
+// relations are found in one pass over the vertices: the incoming particles of a
+// vertex are the parents of its outgoing particles and vice versa. HEPEVT can only
+// store contiguous ranges, so non-contiguous parents or children are stored as the
+// range from the smallest to the largest index.
+void fill_hepevt(const GenEvent& event, const hepevt_output& out, std::size_t offset,
+                 bool fortran) {
+  const int shift = fortran ? 0 : -1;
+  const auto& particles = event.particles();
+  for (std::size_t i = 0; i < particles.size(); ++i) {
+    const GenParticle& p = *particles[i];
+    const FourVector& mom = p.momentum();
+    const std::size_t j = offset + i;
+    out.px[j] = mom.px();
+    out.py[j] = mom.py();
+    out.pz[j] = mom.pz();
+    out.en[j] = mom.e();
+    out.m[j] = p.generated_mass();
+    out.pid[j] = p.pid();
+    out.status[j] = p.status();
+    out.parents[2 * j] = out.parents[2 * j + 1] = shift;
+    out.children[2 * j] = out.children[2 * j + 1] = shift;
+    out.vx[j] = out.vy[j] = out.vz[j] = out.vt[j] = 0;
+  }
+
+  for (const auto& v : event.vertices()) {
+    const auto& in = v->particles_in();
+    const auto& outgoing = v->particles_out();
+    const auto rin = id_range(in);
+    const auto rout = id_range(outgoing);
+    const FourVector& pos = v->position();
+    for (const auto& p : outgoing) {
+      const std::size_t j = offset + p->id() - 1;
+      if (!in.empty()) {
+        out.parents[2 * j] = rin.first + shift;
+        out.parents[2 * j + 1] = rin.second + shift;
+      }
+      out.vx[j] = pos.x();
+      out.vy[j] = pos.y();
+      out.vz[j] = pos.z();
+      out.vt[j] = pos.t();
+    }
+    if (outgoing.empty()) continue;
+    for (const auto& p : in) {
+      const std::size_t j = offset + p->id() - 1;
+      out.children[2 * j] = rout.first + shift;
+      out.children[2 * j + 1] = rout.second + shift;
+    }
+  }
+}
+
+} // namespace
+
+py::dict to_hepevt(const GenEvent& event, bool fortran) {
+  hepevt_output out;
+  auto result = make_hepevt_output(event.particles().size(), out);
+  {
+    py::gil_scoped_release release;
+    fill_hepevt(event, out, 0, fortran);
+  }
+  return result;
+}
+
+py::dict to_hepevt_batch(py::iterable events, bool fortran, int threads) {
+  std::vector<py::object> objects;
+  const auto pevents = collect_events(events, objects);
+  const int nevent = pevents.size();
+
+  std::vector<std::int64_t> offsets(nevent + 1, 0);
+  for (int i = 0; i < nevent; ++i)
+    offsets[i + 1] = offsets[i] + pevents[i]->particles().size();
+
+  hepevt_output out;
+  auto result = make_hepevt_output(offsets.back(), out);
+  {
+    py::gil_scoped_release release;
+    parallel_for(nevent, threads,
+                 [&](int i) { fill_hepevt(*pevents[i], out, offsets[i], fortran); });
+  }
+  py::array_t<std::int64_t> aoffsets(nevent + 1);
+  std::copy(offsets.begin(), offsets.end(), aoffsets.mutable_data());
+  result["offsets"] = aoffsets;
+  return result;
+}
+
+} // namespace HepMC3
@@ -0,0 +1,309 @@
+#include "writer_ascii_fast.hpp"
+#include <HepMC3/Attribute.h>
+#include <HepMC3/GenParticle.h>
+#include <HepMC3/GenRunInfo.h>
+#include <HepMC3/GenVertex.h>
+#include <HepMC3/Units.h>
+#include <HepMC3/Version.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
+
+namespace HepMC3 {
+
+namespace {
+
+// output is written to the stream when the buffer exceeds this size
+constexpr std::size_t buffer_limit = 1 << 20;
+
+// same as WriterAscii::escape
+std::string escape(const std::string& s) {
+  std::string ret;
+  ret.reserve(s.size() * 2);
+  for (const char c : s) {
+    switch (c) {
+      case '\\': ret += "\\\\"; break;
+      case '\n': ret += "\\|"; break;
+      default: ret += c;
+    }
+  }
+  return ret;
+}
+
+// appends the decimal representation, same as printf("%d", x)
+void append_int(std::string& out, long long x) {
+  char tmp[24];
+  char* const end = tmp + sizeof(tmp);
+  char* p = end;
+  unsigned long long u = x < 0 ? 0ull - static_cast<unsigned long long>(x) : x;
+  do {
+    *--p = static_cast<char>('0' + u % 10);
+    u /= 10;
+  } while (u);
+  if (x < 0) *--p = '-';
+  out.append(p, end);
+}
+
+void put_position(std::string& out, const FourVector& pos, int precision) {
+  if (pos.is_zero()) return;
+  out += " @";
+  ascii::put_double(out, pos.x(), precision);
+  ascii::put_double(out, pos.y(), precision);
+  ascii::put_double(out, pos.z(), precision);
+  ascii::put_double(out, pos.t(), precision);
+}
+
+} // namespace
+
+namespace ascii {
+
+void put_int(std::string& out, long long x) {
+  out += ' ';
+  append_int(out, x);
+}
+
+// Formats like printf(" %.*e", precision, x), which WriterAscii uses, or with the
+// shortest representation that reads back to x if precision is 0. CMakeLists.txt
+// compiles this file as C++17 if <charconv> supports floating point numbers, then
+// std::to_chars is used, which gives the same result and is several times faster.
+// Otherwise, snprintf is used.
+void put_double(std::string& out, double x, int precision) {
+  char tmp[64];
+  tmp[0] = ' ';
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  const auto r = precision == 0
+                     ? std::to_chars(tmp + 1, tmp + sizeof(tmp), x)
+                     : std::to_chars(tmp + 1, tmp + sizeof(tmp), x,
+                                     std::chars_format::scientific, precision);
+  out.append(tmp, r.ptr);
+#else
+  int n = 0;
+  if (precision == 0) {
+    // a decimal number with up to 15 significant digits survives the round trip
+    // through a normal double, so %.15g finds it if it exists; otherwise 16 or 17
+    // digits are needed, and 17 always suffice; subnormals have fewer bits
+    const int min_digits = x != 0 && std::abs(x) < DBL_MIN ? 1 : 15;
+    for (int digits = min_digits; digits <= 17; ++digits) {
+      n = std::snprintf(tmp + 1, sizeof(tmp) - 1, "%.*g", digits, x);
+      if (std::strtod(tmp + 1, nullptr) == x) break;
+    }
+  } else {
+    n = std::snprintf(tmp + 1, sizeof(tmp) - 1, "%.*e", precision, x);
+  }
+  out.append(tmp, n + 1);
+#endif
+}
+
+void put_event(std::string& out, int number, std::size_t nvertex, std::size_t nparticle,
+               const FourVector& pos, Units::MomentumUnit mu, Units::LengthUnit lu,
+               int precision) {
+  out += "E";
+  put_int(out, number);
+  put_int(out, nvertex);
+  put_int(out, nparticle);
+  put_position(out, pos, precision);
+  out += "\nU ";
+  out += Units::name(mu);
+  out += " ";
+  out += Units::name(lu);
+  out += "\n";
+}
+
+void put_vertex(std::string& out, int id, int status, const int* in_begin,
+                const int* in_end, const FourVector& pos, int precision) {
+  out += "V";
+  put_int(out, id);
+  put_int(out, status);
+  out += " [";
+  for (const int* it = in_begin; it != in_end; ++it) {
+    if (it != in_begin) out += ',';
+    append_int(out, *it);
+  }
+  out += "]";
+  put_position(out, pos, precision);
+  out += "\n";
+}
+
+void put_particle(std::string& out, int id, int parent, int pid, const FourVector& mom,
+                  double mass, int status, int precision) {
+  out += "P";
+  put_int(out, id);
+  put_int(out, parent);
+  put_int(out, pid);
+  put_double(out, mom.px(), precision);
+  put_double(out, mom.py(), precision);
+  put_double(out, mom.pz(), precision);
+  put_double(out, mom.e(), precision);
+  put_double(out, mass, precision);
+  put_int(out, status);
+  out += "\n";
+}
+
+} // namespace ascii
+
+WriterAsciiFast::WriterAsciiFast(const std::string& filename, GenRunInfoPtr run)
+    : file_(new std::ofstream(filename, std::ios::binary)), stream_(file_.get()) {
+  if (!*file_) throw std::runtime_error("cannot open file " + filename);
+  set_run_info(run);
+  write_header();
+}
+
+WriterAsciiFast::WriterAsciiFast(std::ostream& stream, GenRunInfoPtr run)
+    : stream_(&stream) {
+  set_run_info(run);
+  write_header();
+}
+
+WriterAsciiFast::~WriterAsciiFast() { close(); }
+
+void WriterAsciiFast::write_header() {
+  buffer_.reserve(buffer_limit + (1 << 16));
+  buffer_ += "HepMC::Version ";
+  buffer_ += version();
+  buffer_ += "\nHepMC::Asciiv3-START_EVENT_LISTING\n";
+  if (run_info()) write_run_info();
+  flush(true);
+}
+
+void WriterAsciiFast::set_precision(int prec) {
+  if (prec == 0 || (prec >= 2 && prec <= 24)) precision_ = prec;
+}
+
+void WriterAsciiFast::flush(bool force) {
+  if (buffer_.empty() || (!force && buffer_.size() < buffer_limit)) return;
+  stream_->write(buffer_.data(), buffer_.size());
+  buffer_.clear();
+}
+
+void WriterAsciiFast::put_string(const std::string& s) {
+  buffer_ += s;
+  flush(false);
+}
+
+void WriterAsciiFast::write_run_info() {
+  // like WriterAscii, create an empty run info if there is none
+  if (!run_info()) set_run_info(std::make_shared<GenRunInfo>());
+  const auto& names = run_info()->weight_names();
+  if (!names.empty()) {
+    std::string out = names[0];
+    for (std::size_t i = 1; i < names.size(); ++i) out += "\n" + names[i];
+    buffer_ += "W ";
+    put_string(escape(out));
+    buffer_ += "\n";
+  }
+  for (const auto& tool : run_info()->tools()) {
+    put_string(
+        escape("T " + tool.name + "\n" + tool.version + "\n" + tool.description));
+    buffer_ += "\n";
+  }
+  for (const auto& att : run_info()->attributes()) {
+    std::string st;
+    if (!att.second->to_string(st)) continue;
+    buffer_ += "A ";
+    put_string(att.first);
+    buffer_ += " ";
+    put_string(escape(st));
+    buffer_ += "\n";
+  }
+}
+
+void WriterAsciiFast::write_event(const GenEvent& event) {
+  if (closed_) return;
+
+  if (!run_info()) {
+    set_run_info(event.run_info());
+    write_run_info();
+  } else if (event.run_info() && run_info() != event.run_info()) {
+    set_run_info(event.run_info());
+    write_run_info();
+  }
+
+  const auto& particles = event.particles();
+  const auto& vertices = event.vertices();
+
+  ascii::put_event(buffer_, event.event_number(), vertices.size(), particles.size(),
+                   event.event_pos(), event.momentum_unit(), event.length_unit(),
+                   precision_);
+
+  if (!event.weights().empty()) {
+    buffer_ += "W";
+    for (const auto w : event.weights()) ascii::put_double(buffer_, w, precision_);
+    buffer_ += "\n";
+  }
+
+  for (const auto& kv1 : event.attributes()) {
+    for (const auto& kv2 : kv1.second) {
+      std::string st;
+      if (!kv2.second->to_string(st)) continue;
+      buffer_ += "A";
+      ascii::put_int(buffer_, kv2.first);
+      buffer_ += " ";
+      put_string(kv1.first);
+      buffer_ += " ";
+      put_string(escape(st));
+      buffer_ += "\n";
+    }
+  }
+
+  // production vertex of each particle, from one pass over the vertices
+  std::vector<const GenVertex*> production(particles.size(), nullptr);
+  for (const auto& v : vertices)
+    for (const auto& p : v->particles_out()) production[p->id() - 1] = v.get();
+
+  std::vector<bool> written(vertices.size(), false);
+  std::vector<int> ids;
+  for (std::size_t i = 0; i < particles.size(); ++i) {
+    const GenParticle& p = *particles[i];
+    const GenVertex* v = production[i];
+    int parent = 0;
+    if (v) {
+      // like WriterAscii, a vertex with one incoming particle and without status
+      // and position is not written, the particle refers to its parent instead
+      const auto& in = v->particles_in();
+      if (in.size() > 1 || !v->data().is_zero())
+        parent = v->id();
+      else if (in.size() == 1)
+        parent = in[0]->id();
+      if (parent < 0 && !written[-v->id() - 1]) {
+        written[-v->id() - 1] = true;
+        ids.clear();
+        for (const auto& q : in) ids.push_back(q->id());
+        std::sort(ids.begin(), ids.end());
+        ascii::put_vertex(buffer_, v->id(), v->status(), ids.data(),
+                          ids.data() + ids.size(), v->position(), precision_);
+      }
+    }
+    ascii::put_particle(buffer_, p.id(), parent, p.pid(), p.momentum(),
+                        p.generated_mass(), p.status(), precision_);
+    flush(false);
+  }
+  flush(false);
+}
+
+void WriterAsciiFast::write_formatted(const std::string& text) {
+  if (closed_) return;
+  if (!run_info()) write_run_info();
+  buffer_ += text;
+  flush(false);
+}
+
+bool WriterAsciiFast::failed() { return stream_->fail(); }
+
+void WriterAsciiFast::close() {
+  if (closed_) return;
+  closed_ = true;
+  buffer_ += "HepMC::Asciiv3-END_EVENT_LISTING\n\n";
+  flush(true);
+  stream_->flush();
+  if (file_) file_->close();
+}
+
+} // namespace HepMC3
@@ -0,0 +1,79 @@
+#ifndef PYHEPMC_WRITER_ASCII_FAST_HPP
+#define PYHEPMC_WRITER_ASCII_FAST_HPP
+
+#include "pointer.hpp"
+#include <HepMC3/FourVector.h>
+#include <HepMC3/GenEvent.h>
+#include <HepMC3/Units.h>
+#include <HepMC3/Writer.h>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace HepMC3 {
+
+// Functions which append lines of the HepMC3 ASCII format to a string, formatted
+// like in WriterAscii. Precision 0 selects the shortest representation of floating
+// point numbers, see WriterAsciiFast::set_precision.
+namespace ascii {
+
+void put_int(std::string& out, long long x);
+void put_double(std::string& out, double x, int precision);
+
+// E and U lines
+void put_event(std::string& out, int number, std::size_t nvertex, std::size_t nparticle,
+               const FourVector& pos, Units::MomentumUnit mu, Units::LengthUnit lu,
+               int precision);
+
+// V line, the ids of the incoming particles must be sorted
+void put_vertex(std::string& out, int id, int status, const int* in_begin,
+                const int* in_end, const FourVector& pos, int precision);
+
+// P line
+void put_particle(std::string& out, int id, int parent, int pid, const FourVector& mom,
+                  double mass, int status, int precision);
+
+} // namespace ascii
+
+// Writer for the HepMC3 ASCII format, which produces the same output as
+// HepMC3::WriterAscii at the same precision. Numbers are formatted with
+// std::to_chars, if the standard library supports it for floating point
+// numbers, otherwise with snprintf, into a large output buffer. Particles and
+// vertices are written from one pass over the vertices, without looking up the
+// production vertex of each particle.
+class WriterAsciiFast : public Writer {
+  std::unique_ptr<std::ofstream> file_;
+  std::ostream* stream_;
+  std::string buffer_;
+  int precision_ = 16;
+  bool closed_ = false;
+
+  void flush(bool force);
+  void put_string(const std::string& s);
+  void write_header();
+
+public:
+  WriterAsciiFast(const std::string& filename, GenRunInfoPtr run);
+  WriterAsciiFast(std::ostream& stream, GenRunInfoPtr run);
+  ~WriterAsciiFast();
+
+  void write_event(const GenEvent& event) override;
+  // Appends the text of events which was formatted with the functions in
+  // HepMC3::ascii, after the run info if this was not written yet.
+  void write_formatted(const std::string& text);
+  void write_run_info();
+  bool failed() override;
+  void close() override;
+
+  // number of significant digits after the decimal point, like in WriterAscii;
+  // values outside [2, 24] are ignored, except 0 which selects the shortest
+  // representation which reads back to the same double
+  int precision() const { return precision_; }
+  void set_precision(int prec);
+};
+
+} // namespace HepMC3
+
+#endif
@@ -301,6 +301,97 @@ def test_attributes_3(evt, value):
     assert v1.attributes == {}
 
 
+def test_all_attributes(evt):
+    assert evt.all_attributes() == {}
+    p1, p2 = evt.particles[:2]
+    v1 = evt.vertices[0]
+    evt.attributes["foo"] = 1
+    p1.attributes["flow1"] = 501
+    p2.attributes["flow1"] = 502
+    p2.attributes["bar"] = [1.5, 2.5]
+    v1.attributes["bar"] = "xy"
+    v1.attributes["cs"] = hep.GenCrossSection()
+    del p2.attributes["bar"]
+    a = evt.all_attributes()
+    assert a == {
+        "foo": {0: 1},
+        "flow1": {p1.id: 501, p2.id: 502},
+        "bar": {v1.id: "xy"},
+        "cs": {v1.id: v1.attributes["cs"]},
+    }
+    for p in evt.particles:
+        for k, v in p.attributes.items():
+            assert a[k][p.id] == v
+
+
+def test_numpy_api_attribute(evt):
+    from pyhepmc._core import stringstream
+    from pyhepmc.io import WriterAscii, ReaderAscii, UnparsedAttribute
+
+    p = evt.particles
+    p[0].attributes["flow1"] = 501
+    p[2].attributes["flow1"] = 502
+    p[2].attributes["foo"] = 1.5
+    p[3].attributes["foo"] = "bar"
+    p[1].attributes["half"] = "1.5"
+    p[1].attributes["junk"] = "12abc"
+    p[1].attributes["two"] = 2.0
+    p[1].attributes["big"] = 2.0**40
+    p[1].attributes["nan"] = float("nan")
+    v = evt.vertices
+    v[1].attributes["flow1"] = 7
+    v[1].attributes["z"] = True
+
+    def check(evt):
+        npa = evt.numpy
+        n = len(evt.particles)
+        flow1 = npa.particles.attribute("flow1", dtype=int, default=-1)
+        assert flow1.dtype == np.dtype(int)
+        assert_equal(flow1, [501, -1, 502] + [-1] * (n - 3))
+        flow1 = npa.particles.attribute("flow1", dtype=np.float32)
+        assert_equal(flow1, [501, np.nan, 502] + [np.nan] * (n - 3))
+        assert_equal(npa.particles.attribute("bar", dtype=int), np.zeros(n))
+        m = len(evt.vertices)
+        assert_equal(npa.vertices.attribute("flow1"), [np.nan, 7] + [np.nan] * (m - 2))
+        z = npa.vertices.attribute("z", dtype=bool)
+        assert_equal(z, [False, True] + [False] * (m - 2))
+        with pytest.raises(ValueError):
+            npa.particles.attribute("foo")
+        # the whole string must be a number of the requested type
+        assert npa.particles.attribute("half")[1] == 1.5
+        with pytest.raises(ValueError):
+            npa.particles.attribute("half", dtype=int)
+        with pytest.raises(ValueError):
+            npa.particles.attribute("junk", dtype=int)
+        with pytest.raises(ValueError):
+            npa.particles.attribute("junk")
+        with pytest.raises(TypeError):
+            npa.particles.attribute("flow1", dtype=str)
+        # parsed values must be integral and in range of an integer dtype
+        assert npa.particles.attribute("two", dtype=np.int32)[1] == 2
+        with pytest.raises(ValueError):
+            npa.particles.attribute("foo", dtype=np.int32)
+        with pytest.raises(ValueError):
+            npa.particles.attribute("big", dtype=np.int32)
+        with pytest.raises(ValueError):
+            npa.particles.attribute("nan", dtype=np.int32)
+        with pytest.raises(ValueError):
+            npa.particles.attribute("flow1", dtype=np.int8)
+        flow1 = npa.particles.attribute("flow1", dtype=np.int16)
+        assert_equal(flow1[:3], [501, 0, 502])
+
+    check(evt)
+
+    s = stringstream()
+    with WriterAscii(s) as w:
+        w.write(evt)
+    with ReaderAscii(stringstream(str(s))) as r:
+        evt2 = r.read()
+    check(evt2)
+    # attributes are still unparsed
+    assert isinstance(evt2.particles[0].attributes["flow1"], UnparsedAttribute)
+
+
 def test_FourVector():
     a = hep.FourVector(1, 2, 3, 4)
     b = hep.FourVector([1, 2, 3, 4])
@@ -520,3 +611,288 @@ def test_numpy_api(evt):
     assert_equal(pids, [p.pid for p in evt.particles])
     x = evt.numpy.vertices.x
     assert_equal(x, [v.position.x for v in evt.vertices])
+
+
+def test_numpy_api_to_records(evt):
+    ed = hep.GenEventData()
+    evt.write_data(ed)
+    assert_equal(evt.numpy.particles.to_records(), ed.particles)
+    assert_equal(evt.numpy.vertices.to_records(), ed.vertices)
+
+
+def test_numpy_api_to_columns(evt):
+    c = evt.numpy.particles.to_columns(["px", "pid"])
+    assert list(c) == ["px", "pid"]
+    assert_equal(c["px"], [p.momentum.px for p in evt.particles])
+    assert_equal(c["pid"], [p.pid for p in evt.particles])
+
+    c = evt.numpy.particles.to_columns()
+    for k, v in c.items():
+        assert_equal(v, getattr(evt.numpy.particles, k))
+
+    c = evt.numpy.vertices.to_columns(["t", "status"])
+    assert_equal(c["t"], [v.position.t for v in evt.vertices])
+    assert_equal(c["status"], [v.status for v in evt.vertices])
+
+    with pytest.raises(KeyError):
+        evt.numpy.particles.to_columns(["foo"])
+
+
+def test_numpy_api_out(evt):
+    n = len(evt.particles)
+    assert len(evt.numpy.particles) == n
+    assert len(evt.numpy.vertices) == len(evt.vertices)
+
+    arena = np.zeros(3 * n)
+    pid = np.zeros(n + 2, dtype=np.int32)
+    k = evt.numpy.particles.to_columns(out={"px": arena[n:], "pid": pid})
+    assert k == n
+    assert_equal(arena[:n], 0)
+    assert_equal(arena[n : 2 * n], evt.numpy.particles.px)
+    assert_equal(pid[:n], evt.numpy.particles.pid)
+
+    # strided output
+    out = np.zeros(2 * n)
+    evt.numpy.particles.to_columns(["e"], out={"e": out[::2]})
+    assert_equal(out[::2], evt.numpy.particles.e)
+
+    rec = np.zeros(n + 1, dtype=evt.numpy.particles.to_records().dtype)
+    assert evt.numpy.particles.to_records(out=rec) == n
+    assert_equal(rec[:n], evt.numpy.particles.to_records())
+
+    with pytest.raises(ValueError):
+        evt.numpy.particles.to_columns(out={"px": np.zeros(n - 1)})
+
+    with pytest.raises(ValueError):
+        evt.numpy.particles.to_columns(out={"px": np.zeros(n, dtype=np.int32)})
+
+    # wrong byte order
+    swapped = np.zeros(n, dtype=np.dtype(float).newbyteorder())
+    with pytest.raises(ValueError):
+        evt.numpy.particles.to_columns(out={"px": swapped})
+
+
+def test_ColumnBuffer(evt):
+    buf = hep.ColumnBuffer(["px", "status"])
+    assert buf.capacity == 0
+    c = buf.fill(evt.numpy.particles)
+    assert len(buf) == len(evt.particles)
+    assert buf.capacity == len(evt.particles)
+    assert_equal(c["px"], evt.numpy.particles.px)
+    assert_equal(c["status"], evt.numpy.particles.status)
+    data = c["px"].base
+    c = buf.fill(evt.numpy.particles)
+    assert c["px"].base is data
+
+    vbuf = hep.ColumnBuffer(["x"], capacity=100)
+    c = vbuf.fill(evt.numpy.vertices)
+    assert vbuf.capacity == 100
+    assert_equal(c["x"], evt.numpy.vertices.x)
+
+
+def test_numpy_api_graph(evt):
+    def index(v):
+        return -1 if v is None else -v.id - 1
+
+    npa = evt.numpy
+    assert_equal(
+        npa.particles.production_vertex,
+        [index(p.production_vertex) for p in evt.particles],
+    )
+    assert_equal(npa.particles.end_vertex, [index(p.end_vertex) for p in evt.particles])
+
+    offsets, indices = npa.vertices.particles_in
+    assert len(offsets) == len(evt.vertices) + 1
+    for i, v in enumerate(evt.vertices):
+        a, b = offsets[i : i + 2]
+        assert_equal(indices[a:b], [p.id - 1 for p in v.particles_in])
+
+    offsets, indices = npa.vertices.particles_out
+    for i, v in enumerate(evt.vertices):
+        a, b = offsets[i : i + 2]
+        assert_equal(indices[a:b], [p.id - 1 for p in v.particles_out])
+
+    edges = [
+        (a.id - 1, b.id - 1)
+        for v in evt.vertices
+        for a in v.particles_in
+        for b in v.particles_out
+    ]
+    ei = npa.particles.edge_index
+    assert ei.shape == (2, len(edges))
+    assert_equal(ei.T, edges)
+
+    g = npa.graph()
+    assert_equal(g["edge_index"], ei)
+    assert_equal(g["production_vertex"], npa.particles.production_vertex)
+    assert_equal(g["particles_out"], indices)
+
+    gb = hep.graph_batch(iter([evt, hep.GenEvent(), evt]))
+    n = len(evt.particles)
+    m = len(evt.vertices)
+    assert_equal(gb["particle_offsets"], [0, n, n, 2 * n])
+    assert_equal(gb["vertex_offsets"], [0, m, m, 2 * m])
+    assert_equal(gb["edge_index"], np.concatenate([ei, ei + n], axis=1))
+    pv = g["production_vertex"]
+    assert_equal(gb["production_vertex"], np.append(pv, np.where(pv < 0, -1, pv + m)))
+    assert_equal(gb["particles_in_offsets"][: m + 1], g["particles_in_offsets"])
+    assert len(gb["particles_in_offsets"]) == 2 * m + 1
+
+
+def test_numpy_api_kinematics(evt):
+    npa = evt.numpy.particles
+    for name in ("pt", "eta", "phi", "rap", "m", "p3mod"):
+        # must be bit-identical to FourVector methods
+        expected = [getattr(p.momentum, name)() for p in evt.particles]
+        assert_equal(getattr(npa, name), expected)
+
+
+@pytest.mark.parametrize("threads", (1, 2))
+def test_particles_batch(evt, threads):
+    n = len(evt.particles)
+    c = hep.particles_batch([evt, hep.GenEvent(), evt], ["pt", "pid"], threads=threads)
+    assert list(c) == ["pt", "pid", "offsets"]
+    assert_equal(c["offsets"], [0, n, n, 2 * n])
+    assert_equal(c["pt"], np.tile(evt.numpy.particles.pt, 2))
+    assert_equal(c["pid"], np.tile(evt.numpy.particles.pid, 2))
+
+    m = len(evt.vertices)
+    c = hep.vertices_batch(iter([evt, evt]), threads=threads)
+    assert_equal(c["offsets"], [0, m, 2 * m])
+    for k, v in evt.numpy.vertices.to_columns().items():
+        assert_equal(c[k], np.tile(v, 2))
+
+
+def test_diff(evt):
+    assert hep.diff(evt, evt) is None
+
+    ed = hep.GenEventData()
+    evt.write_data(ed)
+    evt2 = hep.GenEvent()
+    evt2.read_data(ed)
+    evt2.run_info = evt.run_info
+    assert hep.diff(evt, evt2) is None
+
+    evt2.event_number = 42
+    evt2.particles[3].momentum = hep.FourVector(1, 2, 3, 4)
+    evt2.attributes["foo"] = 1
+    d = hep.diff(evt, evt2)
+    assert d.header == ["event_number"]
+    assert_equal(d.particles_a, [3])
+    assert_equal(d.particles_b, [3])
+    # the vertices attached to particle 3 no longer match
+    pv = evt.particles[3].production_vertex
+    ev = evt.particles[3].end_vertex
+    expected = sorted(-v.id - 1 for v in (pv, ev) if v is not None)
+    assert_equal(d.vertices_a, expected)
+    assert_equal(d.vertices_b, expected)
+    assert d.attributes == ["foo"]
+
+    # changes within the tolerance are ignored
+    evt3 = hep.GenEvent()
+    evt3.read_data(ed)
+    evt3.run_info = evt.run_info
+    p = evt3.particles[0]
+    p.momentum = p.momentum + hep.FourVector(0, 0, 0, 1e-3)
+    assert hep.diff(evt, evt3) is not None
+    assert hep.diff(evt, evt3, tolerance=1e-2) is None
+
+
+def test_equal_particle_sets_many_duplicates():
+    # many identical particles, which is quadratic for a linear search
+    def make(n):
+        evt = hep.GenEvent()
+        for i in range(n):
+            evt.add_particle(hep.GenParticle((0, 0, i % 3, 1), 211, 1))
+        return evt.particles
+
+    a = make(20000)
+    b = make(20000)
+    assert hep.equal_particle_sets(a, b[::-1])
+    assert not hep.equal_particle_sets(a, b[1:])
+    b[-1].pid = 22
+    assert not hep.equal_particle_sets(a, b)
+
+
+@pytest.mark.parametrize("threads", (1, 2))
+def test_diff_files(evt, tmp_path, threads):
+    fn1 = tmp_path / "a.dat"
+    fn2 = tmp_path / "b.dat"
+    evt2 = hep.GenEvent()
+    ed = hep.GenEventData()
+    evt.write_data(ed)
+    evt2.read_data(ed)
+    evt2.particles[0].pid = 22
+    with hep.open(fn1, "w") as f:
+        for _ in range(5):
+            f.write(evt)
+    with hep.open(fn2, "w") as f:
+        for i in range(6):
+            f.write(evt2 if i == 3 else evt)
+
+    d = hep.diff(fn1, fn1, threads=threads, batch_size=2)
+    assert not d
+    assert d.size_a == d.size_b == 5
+
+    d = hep.diff(fn1, fn2, threads=threads, batch_size=2)
+    assert d
+    assert list(d.events) == [3]
+    assert_equal(d.events[3].particles_a, [0])
+    assert (d.size_a, d.size_b) == (5, 6)
+
+
+@pytest.mark.parametrize("protocol", (2, 4, 5))
+def test_GenEvent_pickle(evt, protocol):
+    import pickle
+
+    evt.attributes["foo"] = 1
+    s = pickle.dumps(evt, protocol=protocol)
+    evt2 = pickle.loads(s)
+    assert evt2 == evt
+    assert "foo" in evt2.attributes
+    assert evt2.run_info == evt.run_info
+
+    if protocol < 5:
+        return
+
+    buffers = []
+    s = pickle.dumps(evt, protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) == 5
+    nbytes = sum(b.raw().nbytes for b in buffers)
+    assert nbytes > len(evt.particles) * 40
+    evt3 = pickle.loads(s, buffers=buffers)
+    assert evt3 == evt
+
+
+def test_GenEvent_pickle_empty():
+    import pickle
+
+    evt = hep.GenEvent()
+    assert pickle.loads(pickle.dumps(evt, protocol=5)) == evt
+
+
+def test_GenEventData_set_arrays(evt):
+    ed = hep.GenEventData()
+    evt.write_data(ed)
+    ed2 = hep.GenEventData()
+    for name in ("particles", "vertices", "weights", "links1", "links2"):
+        setattr(ed2, name, getattr(ed, name).copy())
+    for name in ("attribute_id", "attribute_name", "attribute_string"):
+        setattr(ed2, name, getattr(ed, name))
+    ed2.event_number = ed.event_number
+    ed2.momentum_unit = ed.momentum_unit
+    ed2.length_unit = ed.length_unit
+    ed2.event_pos = ed.event_pos
+    assert ed2 == ed
+
+    ed2.weights = [1, 2, 3]
+    assert_equal(ed2.weights, [1.0, 2.0, 3.0])
+    with pytest.raises(ValueError):
+        ed2.links1 = np.zeros((2, 2))
+
+
+def test_GenRunInfo_pickle(evt):
+    import pickle
+
+    ri = pickle.loads(pickle.dumps(evt.run_info))
+    assert ri == evt.run_info
@@ -1,6 +1,8 @@
 import pyhepmc as hep
 import numpy as np
 import pytest
+from io import BytesIO
+from pathlib import Path
 
 
 @pytest.mark.parametrize("fortran", (True, False))
@@ -81,3 +83,265 @@ def test_negative_parents_range(bad, fortran):
         hep.GenEvent().from_hepevt(
             0, px, py, pz, en, m, pid, sta, parents, fortran=fortran
         )
+
+
+@pytest.mark.parametrize("threads", (1, 2))
+@pytest.mark.parametrize("fortran", (True, False))
+def test_from_hepevt_batch(threads, fortran):
+    # three events with 4, 0, and 6 particles
+    offsets = [0, 4, 4, 10]
+    n = offsets[-1]
+    px = np.linspace(0, 1, n)
+    py = px + 1
+    pz = px + 2
+    en = px + 10
+    m = px * 0.5
+    pid = np.arange(n) + 1
+    sta = np.arange(n) % 3
+    parents = np.array(
+        [(0, 0), (0, 0), (1, 2), (1, 2)]
+        + [(0, 0), (0, 0), (1, 1), (2, 2), (3, 4), (3, 4)]
+    )
+    vx = vy = vz = vt = np.arange(n, dtype=float)
+    if not fortran:
+        parents -= 1
+
+    events = hep.from_hepevt_batch(
+        px,
+        py,
+        pz,
+        en,
+        m,
+        pid,
+        sta,
+        parents,
+        None,
+        vx,
+        vy,
+        vz,
+        vt,
+        offsets=offsets,
+        event_number=[5, 6, 7],
+        fortran=fortran,
+        threads=threads,
+    )
+
+    assert len(events) == 3
+    for i, ev in enumerate(events):
+        a, b = offsets[i : i + 2]
+        ref = hep.GenEvent()
+        ref.from_hepevt(
+            5 + i,
+            px[a:b],
+            py[a:b],
+            pz[a:b],
+            en[a:b],
+            m[a:b],
+            pid[a:b],
+            sta[a:b],
+            parents[a:b],
+            None,
+            vx[a:b],
+            vy[a:b],
+            vz[a:b],
+            vt[a:b],
+            fortran=fortran,
+        )
+        assert ev.event_number == 5 + i
+        assert ev == ref
+
+    from pyhepmc._core import stringstream
+    from pyhepmc.io import WriterAscii, ReaderAscii
+
+    s = stringstream()
+    with WriterAscii(s) as w:
+        nwritten = hep.from_hepevt_batch(
+            px, py, pz, en, m, pid, sta, parents, offsets=offsets, writer=w
+        )
+    assert nwritten == 3
+    with ReaderAscii(stringstream(str(s))) as r:
+        ev = r.read()
+    assert ev.event_number == 0
+    assert ev.particles == events[0].particles
+
+    with pytest.raises(RuntimeError, match="offsets"):
+        hep.from_hepevt_batch(
+            px, py, pz, en, m, pid, sta, offsets=[0, 4, 2], threads=threads
+        )
+
+    bad = parents.copy()
+    bad[8] = (10, 20)
+    with pytest.raises(RuntimeError, match="event 2"):
+        hep.from_hepevt_batch(
+            px, py, pz, en, m, pid, sta, bad, offsets=offsets, threads=threads
+        )
+
+
+@pytest.mark.parametrize("fortran", (True, False))
+def test_to_hepevt(fortran):
+    px = np.linspace(0, 1, 6)
+    py = px + 1
+    pz = px + 2
+    en = px + 10
+    m = px * 0.5
+    pid = np.arange(6) + 1
+    sta = np.arange(6) % 3
+    parents = np.array([(0, 0), (0, 0), (1, 2), (1, 2), (3, 4), (3, 4)])
+    children = np.array([(3, 4), (3, 4), (5, 6), (5, 6), (0, 0), (0, 0)])
+    vx = np.array([0, 0, 1, 1, 2, 2], dtype=float)
+    vy = vx + 1
+    vz = vx + 2
+    vt = vx + 3
+    vy[:2] = vz[:2] = vt[:2] = 0
+    if not fortran:
+        parents -= 1
+        children -= 1
+
+    evt = hep.GenEvent()
+    evt.from_hepevt(
+        0, px, py, pz, en, m, pid, sta, parents, None, vx, vy, vz, vt, fortran=fortran
+    )
+    d = evt.to_hepevt(fortran=fortran)
+
+    for k, v in dict(
+        px=px,
+        py=py,
+        pz=pz,
+        en=en,
+        m=m,
+        pid=pid,
+        status=sta,
+        parents=parents,
+        children=children,
+        vx=vx,
+        vy=vy,
+        vz=vz,
+        vt=vt,
+    ).items():
+        np.testing.assert_equal(d[k], v, err_msg=k)
+
+    evt2 = hep.GenEvent()
+    evt2.from_hepevt(0, **d, fortran=fortran)
+    assert evt2 == evt
+
+    d = hep.GenEvent().to_hepevt()
+    assert d["px"].shape == (0,)
+    assert d["parents"].shape == (0, 2)
+
+
+@pytest.mark.parametrize("threads", (1, 2))
+def test_to_hepevt_batch(threads):
+    with hep.open(Path(__file__).parent / "pythia6.dat") as f:
+        evt = f.read()
+    events = [evt, hep.GenEvent(), evt]
+    d = hep.to_hepevt_batch(iter(events), threads=threads)
+    n = len(evt.particles)
+    np.testing.assert_equal(d["offsets"], [0, n, n, 2 * n])
+    ref = evt.to_hepevt()
+    for k, v in ref.items():
+        np.testing.assert_equal(d[k][:n], v, err_msg=k)
+        np.testing.assert_equal(d[k][n:], v, err_msg=k)
+
+    events2 = hep.from_hepevt_batch(**d, threads=threads)
+    assert len(events2) == 3
+    assert len(events2[1].particles) == 0
+    assert events2[0].particles == events2[2].particles
+
+
+@pytest.mark.parametrize("threads", (1, 2))
+@pytest.mark.parametrize("relation", ("parents", "children"))
+@pytest.mark.parametrize("vertex", (False, True))
+@pytest.mark.parametrize("fortran", (True, False))
+def test_write_batch(threads, relation, vertex, fortran):
+    from pyhepmc._core import stringstream
+    from pyhepmc.io import WriterAscii, WriterAsciiFast
+
+    fn = Path(__file__).parent / "pythia6.dat"
+    with hep.open(fn) as f:
+        events = [ev for ev in f]
+    d = hep.to_hepevt_batch(events, fortran=fortran)
+    offsets = d.pop("offsets")
+    other = "children" if relation == "parents" else "parents"
+    d[other] = None
+    if not vertex:
+        for key in ("vx", "vy", "vz", "vt"):
+            d[key] = None
+
+    # overlapping ranges, particles are attached to several vertices
+    invalid = 0 if fortran else -1
+    rel = np.full((6, 2), invalid, dtype=np.int32)
+    rel[:4] = np.array([(3, 4), (3, 5), (4, 6), (5, 6)]) - (not fortran)
+    extra = {key: np.arange(6) + 1 for key in ("px", "py", "pz", "en", "m", "pid")}
+    extra["status"] = np.ones(6, dtype=np.int32)
+    extra[relation] = rel
+    extra[other] = None
+    for key in ("vx", "vy", "vz", "vt"):
+        extra[key] = np.arange(6, dtype=float) if vertex else None
+    for key, val in extra.items():
+        if val is not None:
+            d[key] = np.concatenate([d[key], val])
+    offsets = np.append(offsets, offsets[-1] + 6)
+
+    outputs = []
+    for Writer in (WriterAscii, WriterAsciiFast):
+        s = stringstream()
+        with Writer(s) as w:
+            n = w.write_batch(**d, offsets=offsets, fortran=fortran, threads=threads)
+        assert n == len(offsets) - 1
+        outputs.append(str(s))
+
+    assert outputs[0] == outputs[1]
+
+    # pyhepmc.open writes HepMC3 with WriterAsciiFast, which formats batches directly
+    with BytesIO() as f:
+        with hep.open(f, "w") as out:
+            n = out.write_batch(**d, offsets=offsets, fortran=fortran, threads=threads)
+            assert isinstance(out._writer.writer(), WriterAsciiFast)
+        assert n == len(offsets) - 1
+        assert f.getvalue().decode() == outputs[0]
+
+
+def _hepevt_key(evt):
+    # particles with their parents, independent of the particle order; momenta are
+    # rounded like in the HEPEVT text
+    def r(x):
+        return float(f"{x:.8E}")
+
+    def key(p):
+        m = p.momentum
+        return (p.pid, p.status, r(m.px), r(m.py), r(m.pz))
+
+    return sorted((key(p), sorted(key(q) for q in p.parents)) for p in evt.particles)
+
+
+@pytest.mark.parametrize("threads", (1, 2))
+@pytest.mark.parametrize("fortran", (True, False))
+def test_write_batch_hepevt(threads, fortran):
+    from pyhepmc._core import stringstream
+    from pyhepmc.io import WriterHEPEVT, ReaderHEPEVT
+
+    fn = Path(__file__).parent / "pythia6.dat"
+    with hep.open(fn) as f:
+        events = [ev for ev in f]
+    d = hep.to_hepevt_batch(events, fortran=fortran)
+    offsets = d.pop("offsets")
+    d["children"] = None
+    refs = hep.from_hepevt_batch(**d, offsets=offsets, fortran=fortran)
+
+    s = stringstream()
+    with WriterHEPEVT(s) as w:
+        n = w.write_batch(**d, offsets=offsets, fortran=fortran, threads=threads)
+    assert n == len(events)
+
+    with ReaderHEPEVT(stringstream(str(s))) as r:
+        events2 = list(r)
+
+    assert len(events2) == len(refs)
+    for evt, ref in zip(events2, refs):
+        assert evt.event_number == ref.event_number
+        assert _hepevt_key(evt) == _hepevt_key(ref)
+
+    with BytesIO() as f:
+        with hep.open(f, "w", format="hepevt") as out:
+            out.write_batch(**d, offsets=offsets, fortran=fortran, threads=threads)
+        assert f.getvalue().decode() == str(s)
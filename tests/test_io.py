@@ -553,7 +553,7 @@ def test_attributes():
     os.unlink(filename)
 
 
-@pytest.mark.parametrize("format", ["hepmc3", "hepmc2", "hepevt"])
+@pytest.mark.parametrize("format", ["hepmc3", "hepmc2", "hepevt", "columnar"])
 def test_roundtrip(evt, format):
     fn = "test_roundtrip.dat"
 
@@ -596,3 +596,577 @@ def test_zip(evt, zip):
     os.unlink(fn)
 
     assert evt == evt2
+
+
+@pytest.mark.parametrize("use_pyiostream", (False, True))
+def test_read_in_threads(use_pyiostream):
+    from concurrent.futures import ThreadPoolExecutor
+
+    fn = str(Path(__file__).parent / "pythia6.dat")
+
+    def read(_):
+        if use_pyiostream:
+            with open(fn, "rb") as f:
+                with pyiostream(f, 1000) as s:
+                    with io.ReaderAscii(s) as r:
+                        return list(r)
+        with io.ReaderAscii(fn) as r:
+            return list(r)
+
+    ref = read(None)
+    assert len(ref) > 0
+
+    with ThreadPoolExecutor(4) as ex:
+        for events in ex.map(read, range(8)):
+            assert events == ref
+
+
+def test_read_batch(evt):
+    fn = "test_read_batch.dat"
+    with io.open(fn, "w") as f:
+        for i in range(5):
+            evt.event_number = i
+            f.write(evt)
+
+    with io.open(fn) as f:
+        events = list(f)
+
+    with io.ReaderAscii(fn) as f:
+        b1 = f.read_batch(3)
+        b2 = f.read_batch(3)
+        b3 = f.read_batch(3)
+
+    with io.open(fn) as f:
+        b4 = f.read_batch(10)
+
+    os.unlink(fn)
+
+    assert list(b1["event_number"]) == [0, 1, 2]
+    assert list(b2["event_number"]) == [3, 4]
+    assert len(b3["event_number"]) == 0
+    assert list(b3["particle_offsets"]) == [0]
+    assert list(b4["event_number"]) == [0, 1, 2, 3, 4]
+
+    po = b4["particle_offsets"]
+    vo = b4["vertex_offsets"]
+    assert len(po) == 6
+    for i, ev in enumerate(events):
+        ed = hep.GenEventData()
+        ev.write_data(ed)
+        assert b4["particles"][po[i] : po[i + 1]].tolist() == ed.particles.tolist()
+        assert b4["vertices"][vo[i] : vo[i + 1]].tolist() == ed.vertices.tolist()
+        lo = b4["link_offsets"]
+        assert b4["links1"][lo[i] : lo[i + 1]].tolist() == ed.links1.tolist()
+        assert b4["links2"][lo[i] : lo[i + 1]].tolist() == ed.links2.tolist()
+
+
+@pytest.mark.parametrize("suffix", (".gz", ".zst"))
+def test_decompress_iostream(evt, suffix):
+    from pyhepmc._core import decompress_iostream, _native_decompression
+
+    if suffix not in _native_decompression:
+        pytest.skip(f"no native decompression for {suffix}")
+
+    fn = "test_decompress_iostream.dat" + suffix
+    with io.open(fn, "w") as f:
+        for i in range(3):
+            evt.event_number = i
+            f.write(evt)
+
+    with decompress_iostream(fn, 100) as s:
+        with io.ReaderAscii(s) as r:
+            events = list(r)
+
+    with io.open(fn) as f:
+        assert isinstance(f._ios, decompress_iostream)
+        events2 = list(f)
+
+    os.unlink(fn)
+
+    assert len(events) == 3
+    assert events == events2
+    assert [e.event_number for e in events] == [0, 1, 2]
+
+
+def test_decompress_iostream_crlf_and_truncated(evt):
+    from pyhepmc._core import _native_decompression
+
+    if ".gz" not in _native_decompression:
+        pytest.skip("no native decompression for .gz")
+
+    fn = "test_decompress_iostream_crlf.dat"
+    with io.open(fn, "w") as f:
+        for i in range(3):
+            evt.event_number = i
+            f.write(evt)
+    with io.open(fn) as f:
+        expected = list(f)
+    with open(fn, "rb") as f:
+        content = f.read()
+    os.unlink(fn)
+
+    # \r\n line endings are converted like for uncompressed files
+    data = gzip.compress(content.replace(b"\n", b"\r\n"))
+    fn += ".gz"
+    with open(fn, "wb") as f:
+        f.write(data)
+    with io.open(fn) as f:
+        events = list(f)
+
+    # a truncated file is an error, not a silent end of file
+    with open(fn, "wb") as f:
+        f.write(data[: len(data) // 2])
+    with pytest.raises(RuntimeError, match="end-of-stream"):
+        with io.open(fn) as f:
+            list(f)
+
+    os.unlink(fn)
+
+    assert len(events) == 3
+    assert events == expected
+
+
+@pytest.mark.parametrize("prefetch", (True, (2, 100)))
+@pytest.mark.parametrize("suffix", ("", ".gz", ".bz2"))
+def test_open_prefetch(evt, prefetch, suffix):
+    fn = "test_open_prefetch.dat" + suffix
+    with io.open(fn, "w") as f:
+        for i in range(10):
+            evt.event_number = i
+            f.write(evt)
+
+    with io.open(fn) as f:
+        events = list(f)
+
+    with io.open(fn, prefetch=prefetch) as f:
+        events2 = list(f)
+
+    # closing early must stop the background thread
+    with io.open(fn, prefetch=prefetch) as f:
+        f.read()
+
+    os.unlink(fn)
+
+    assert len(events) == 10
+    assert events == events2
+
+    with pytest.raises(ValueError):
+        io.open(fn, "w", prefetch=True)
+
+    s = stringstream()
+    with pytest.raises(ValueError):
+        pyiostream_prefetch = io.prefetch_iostream(s, 1, 100)  # noqa: F841
+
+
+@pytest.mark.parametrize("threads", (1, 3))
+@pytest.mark.parametrize("batch_size", (1, 4, 256))
+def test_ReaderAsciiParallel(evt, threads, batch_size):
+    fn = "test_ReaderAsciiParallel.dat"
+    with io.open(fn, "w") as f:
+        for i in range(10):
+            evt.event_number = i
+            f.write(evt)
+
+    with io.ReaderAscii(fn) as r:
+        events = list(r)
+
+    with io.ReaderAsciiParallel(fn, threads, batch_size) as r:
+        events2 = list(r)
+        assert r.read() is None
+
+    with open(fn, "rb") as f:
+        with pyiostream(f, 1000) as s:
+            with io.ReaderAsciiParallel(s, threads, batch_size) as r:
+                events3 = list(r)
+
+    with io.open(fn, threads=threads) as f:
+        events4 = list(f)
+
+    os.unlink(fn)
+
+    assert len(events) == 10
+    assert events2 == events
+    assert events3 == events
+    assert events4 == events
+    assert events2[0].run_info == events[0].run_info
+    # all events share the run info
+    assert events2[0].run_info is events2[-1].run_info
+
+    with pytest.raises(ValueError):
+        io.open(fn, "w", threads=2)
+
+
+@pytest.mark.parametrize("threads", (1, 3))
+@pytest.mark.parametrize("batch_size", (1, 4, 256))
+def test_ReaderAsciiParallel_run_info_change(evt, threads, batch_size):
+    fn = "test_ReaderAsciiParallel_run_info_change.dat"
+    ri1 = hep.GenRunInfo()
+    ri1.weight_names = ["a"]
+    ri2 = hep.GenRunInfo()
+    ri2.weight_names = ["b", "c"]
+    names = []
+    with io.open(fn, "w") as f:
+        for i in range(10):
+            evt.event_number = i
+            # the new run info is written before event 5
+            evt.run_info = ri1 if i < 5 else ri2
+            evt.weights = [1.0] * len(evt.run_info.weight_names)
+            names.append(evt.run_info.weight_names)
+            f.write(evt)
+
+    with io.ReaderAsciiParallel(fn, threads, batch_size) as r:
+        events = list(r)
+
+    os.unlink(fn)
+
+    assert [e.event_number for e in events] == list(range(10))
+    assert [e.run_info.weight_names for e in events] == names
+    assert events[0].run_info is events[4].run_info
+    assert events[5].run_info is events[9].run_info
+    assert [e.weight_names for e in events] == names
+
+
+def test_ReaderAsciiParallel_last_event_issue():
+    fn = str(Path(__file__).parent / "last_event_issue.hepmc")
+
+    with io.ReaderAscii(fn) as r:
+        events = list(r)
+
+    with io.ReaderAsciiParallel(fn, 2, 2) as r:
+        events2 = list(r)
+
+    assert events2 == events
+
+
+@pytest.mark.parametrize("batch_size", (1, 4, 256))
+def test_ReaderAsciiParallel_broken(evt, batch_size):
+    fn = Path(__file__).parent / "broken.dat"
+
+    with io.ReaderAscii(str(fn)) as r:
+        events = list(r)
+
+    with io.ReaderAsciiParallel(str(fn), 2, batch_size) as r:
+        events2 = list(r)
+        assert r.failed()
+
+    assert events2 == events
+
+    # good events followed by the broken event and more good events
+    broken = fn.read_text()
+    broken = broken[broken.index("\nE ") + 1 :]
+    s = stringstream()
+    with io.WriterAscii(s) as w:
+        for i in range(5):
+            evt.event_number = i
+            w.write(evt)
+    text = str(s).replace("HepMC::Asciiv3-END_EVENT_LISTING\n", "")
+    text += broken + text[text.index("\nE ") + 1 :]
+
+    with io.ReaderAscii(stringstream(text)) as r:
+        events = list(r)
+
+    with io.ReaderAsciiParallel(stringstream(text), 2, batch_size) as r:
+        events2 = list(r)
+        assert r.read() is None
+
+    assert len(events) == 5
+    assert events2 == events
+
+
+def test_mmap_iostream(evt):
+    from pyhepmc._core import mmap_iostream
+
+    fn = "test_mmap_iostream.dat"
+    with io.open(fn, "w") as f:
+        for i in range(3):
+            evt.event_number = i
+            f.write(evt)
+
+    with io.ReaderAscii(fn) as r:
+        events = list(r)
+
+    with mmap_iostream(fn) as s:
+        with io.ReaderAscii(s) as r:
+            events2 = list(r)
+
+    with io.open(fn) as f:
+        assert isinstance(f._ios, mmap_iostream)
+        events3 = list(f)
+
+    # opt out of the mapping, e.g. for files which are still being written
+    with io.open(fn, mmap=False) as f:
+        assert isinstance(f._ios, pyiostream)
+        events5 = list(f)
+        with pytest.raises(IOError):
+            len(f)
+
+    # \r\n line endings are converted, the file itself is not modified
+    with open(fn, "rb") as f:
+        content = f.read()
+    with open(fn, "wb") as f:
+        f.write(content.replace(b"\n", b"\r\n"))
+
+    with io.open(fn) as f:
+        events4 = list(f)
+
+    with open(fn, "rb") as f:
+        assert f.read() == content.replace(b"\n", b"\r\n")
+
+    os.unlink(fn)
+
+    assert len(events) == 3
+    assert events2 == events
+    assert events3 == events
+    assert events4 == events
+    assert events5 == events
+
+    with pytest.raises(RuntimeError):
+        mmap_iostream("file_does_not_exist.dat")
+
+
+@pytest.mark.parametrize("compression", (0, 3))
+def test_columnar(evt, compression):
+    fn = "test_columnar.dat"
+    evt.run_info.weight_names = ["0"]
+
+    with io.WriterColumnar(fn, evt.run_info, 2, compression) as w:
+        for i in range(5):
+            evt.event_number = i
+            w.write(evt)
+
+    with io.ReaderColumnar(fn) as r:
+        assert r.num_events() == 5
+        events = list(r)
+
+        r.seek_event(3)
+        assert r.read().event_number == 3
+        r.seek_event(0)
+        assert r.read().event_number == 0
+
+        with pytest.raises(IndexError):
+            r.seek_event(5)
+
+        # seek into the last batch, which is still loaded, after reaching EOF
+        assert len(list(r)) == 4
+        assert r.read() is None
+        r.seek_event(4)
+        assert [e.event_number for e in r] == [4]
+        r.seek_event(3)
+        assert [e.event_number for e in r] == [3, 4]
+
+    # columnar format is detected automatically
+    with io.open(fn) as f:
+        events2 = list(f)
+
+    # streams which convert line endings would corrupt the binary data
+    from pyhepmc._core import mmap_iostream
+
+    with pytest.raises(TypeError):
+        io.ReaderColumnar(mmap_iostream(fn))
+    with open(fn, "rb") as f:
+        with pytest.raises(TypeError):
+            io.ReaderColumnar(pyiostream(f, 1000))
+    with BytesIO() as f:
+        with pytest.raises(TypeError):
+            io.WriterColumnar(pyiostream(f, 1000))
+
+    # the reader does not consume the stream which prefetch would wrap
+    with pytest.raises(ValueError, match="prefetch"):
+        io.open(fn, prefetch=True)
+
+    os.unlink(fn)
+
+    assert [e.event_number for e in events] == [0, 1, 2, 3, 4]
+    for e in events:
+        evt.event_number = e.event_number
+        assert e == evt
+    assert events2 == events
+
+    with pytest.raises(ValueError, match="uncompressed"):
+        io.open(fn + ".gz", "w", format="columnar")
+
+
+@pytest.mark.parametrize("format", ("hepmc3", "hepmc2", "columnar"))
+def test_seek_event(evt, format):
+    fn = "test_seek_event.dat"
+    if format != "hepmc3":
+        evt.run_info = hep.GenRunInfo()
+    evt.run_info.weight_names = ["0"]
+    with io.open(fn, "w", format=format) as f:
+        for i in range(10):
+            evt.event_number = 100 + i
+            f.write(evt)
+
+    if format != "columnar":
+        offsets, event_numbers = io.event_index(fn)
+        assert len(offsets) == 10
+        assert list(event_numbers) == list(range(100, 110))
+        assert os.path.exists(fn + ".idx.npz")
+        # cached index is reused
+        offsets2, _ = io.event_index(fn)
+        assert list(offsets2) == list(offsets)
+
+    with io.open(fn) as f:
+        assert len(f) == 10
+        evt2 = f[7]
+        assert evt2.event_number == 107
+        # reading continues after the seeked event
+        assert f.read().event_number == 108
+        assert [e.event_number for e in f[2:5]] == [102, 103, 104]
+        assert f[-1].event_number == 109
+        assert f.read() is None
+        f.seek_event(0)
+        assert f.read().event_number == 100
+        with pytest.raises(IndexError):
+            f[10]
+
+    evt.event_number = 107
+    assert evt2 == evt
+
+    if format == "hepmc3":
+        # no random access when parsing in threads
+        with io.open(fn, threads=2) as f:
+            with pytest.raises(IOError):
+                f.seek_event(0)
+
+    os.unlink(fn)
+    if os.path.exists(fn + ".idx.npz"):
+        os.unlink(fn + ".idx.npz")
+
+
+@pytest.mark.parametrize("format", ("hepmc3", "columnar"))
+def test_shard(evt, format):
+    fn = "test_shard.dat"
+    with io.open(fn, "w", format=format) as f:
+        for i in range(10):
+            evt.event_number = i
+            f.write(evt)
+
+    numbers = []
+    for k in range(3):
+        numbers += [e.event_number for e in io.shard(fn, k, 3)]
+
+    one = [e.event_number for e in io.shard(fn, 0, 1)]
+
+    os.unlink(fn)
+    if os.path.exists(fn + ".idx.npz"):
+        os.unlink(fn + ".idx.npz")
+
+    # every event appears in exactly one shard, in file order
+    assert numbers == list(range(10))
+    assert one == list(range(10))
+
+    with pytest.raises(ValueError):
+        next(io.shard(fn, 3, 3))
+
+
+def _event_number(evt):
+    return evt.event_number
+
+
+def _batch_len(events):
+    return len(events)
+
+
+def _add(a, b):
+    return a + b
+
+
+@pytest.mark.parametrize("workers", (1, 3))
+def test_process(evt, workers):
+    fns = ["test_process_1.dat", "test_process_2.dat.gz"]
+    for j, fn in enumerate(fns):
+        with io.open(fn, "w") as f:
+            for i in range(10):
+                evt.event_number = 10 * j + i
+                f.write(evt)
+
+    r1 = hep.process(fns, _event_number, workers=workers)
+    r2 = hep.process(fns, _event_number, workers=workers, reduce=_add)
+    r3 = hep.process(fns[0], _batch_len, workers=workers, batch_size=4)
+    r4 = hep.process(fns[0], _batch_len, workers=workers, batch_size=4, reduce=_add)
+
+    for fn in fns:
+        os.unlink(fn)
+        if os.path.exists(fn + ".idx.npz"):
+            os.unlink(fn + ".idx.npz")
+
+    assert r1 == list(range(20))
+    assert r2 == sum(range(20))
+    assert sum(r3) == 10
+    assert max(r3) <= 4
+    assert r4 == 10
+
+
+@pytest.mark.parametrize("precision", (2, 8, 16, 24))
+def test_WriterAsciiFast(evt, precision):
+    fn = str(Path(__file__).parent / "pythia6.dat")
+    with io.ReaderAscii(fn) as r:
+        events = [evt] + [e for e in r]
+
+    outputs = []
+    for Writer in (io.WriterAscii, io.WriterAsciiFast):
+        s = stringstream()
+        with Writer(s) as w:
+            w.precision = precision
+            assert w.precision == precision
+            for e in events:
+                w.write(e)
+        outputs.append(str(s))
+
+    assert outputs[0] == outputs[1]
+
+
+def test_WriterAsciiFast_shortest(evt):
+    evt.particles[0].momentum = (0.1, 0.2, 1.5, 3.0)
+    s = stringstream()
+    with io.WriterAsciiFast(s) as w:
+        w.precision = 0
+        assert w.precision == 0
+        w.write(evt)
+
+    # shortest representation, not just 17 significant digits
+    assert " 0.1 0.2 1.5 3 " in str(s)
+
+    s2 = stringstream()
+    with io.WriterAscii(s2) as w:
+        w.write(evt)
+
+    assert len(str(s)) < len(str(s2))
+
+    with io.ReaderAscii(stringstream(str(s))) as r:
+        evt2 = r.read()
+
+    assert evt == evt2
+
+
+@pytest.mark.parametrize("format", ("hepmc3", "hepmc2", "columnar", "parallel"))
+def test_read_reuse(evt, format):
+    fn = f"test_read_reuse_{format}.dat"
+    with io.open(fn, "w", format="hepmc3" if format == "parallel" else format) as f:
+        for i in range(3):
+            evt.event_number = i
+            f.write(evt)
+
+    kwargs = {"threads": 2} if format == "parallel" else {}
+    with io.open(fn, **kwargs) as f:
+        expected = [e.event_number for e in f]
+    with io.open(fn, **kwargs) as f:
+        into = hep.GenEvent()
+        first = f.read(into=into)
+        assert first is into
+        n = len(into.particles)
+        events = list(f.iterate(reuse=True))
+        assert f.read(into=into) is None
+
+    os.unlink(fn)
+    if os.path.exists(fn + ".idx.npz"):
+        os.unlink(fn + ".idx.npz")
+
+    assert expected == [0, 1, 2]
+    assert n == len(evt.particles)
+    # all iterations return the same object, which holds the last event
+    assert len(events) == 2
+    assert events[0] is events[1]
+    assert events[0].event_number == 2
+    assert len(events[0].particles) == len(evt.particles)
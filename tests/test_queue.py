@@ -0,0 +1,93 @@
+import multiprocessing as mp
+import pyhepmc as hep
+import pytest
+import threading
+from numpy.testing import assert_equal
+from test_basic import make_evt
+
+
+def test_EventQueue_roundtrip():
+    evt = make_evt()
+    evt.attributes["foo"] = 1
+    with hep.EventQueue(slots=2, slot_size=1 << 14) as q:
+        q.put(evt)
+        ed = hep.GenEventData()
+        evt.write_data(ed)
+        q.put(ed)
+        q.finish()
+
+        with q.get() as record:
+            assert record.event_number == evt.event_number
+            assert record.momentum_unit == evt.momentum_unit
+            assert_equal(record.particles, ed.particles)
+            assert_equal(record.vertices, ed.vertices)
+            assert_equal(record.links1, ed.links1)
+            assert_equal(record.links2, ed.links2)
+            assert record.attribute_name == ed.attribute_name
+            evt2 = record.to_event()
+        assert record.particles is None
+
+        evt3 = next(q.events())
+        assert q.get() is None
+        # end marker is seen by every consumer
+        assert q.get() is None
+
+    for e in (evt2, evt3):
+        e.run_info = evt.run_info
+        assert e == evt
+        assert "foo" in e.attributes
+
+
+def test_EventQueue_too_large():
+    evt = make_evt()
+    with hep.EventQueue(slots=1, slot_size=256) as q:
+        with pytest.raises(ValueError):
+            q.put(evt)
+
+    with pytest.raises(ValueError):
+        hep.EventQueue(slot_size=100)
+
+
+def test_EventQueue_backpressure():
+    evt = make_evt()
+    with hep.EventQueue(slots=1, slot_size=1 << 14) as q:
+        q.put(evt)
+        t = threading.Thread(target=q.put, args=(evt,))
+        t.start()
+        t.join(0.2)
+        # producer waits until the only slot is released
+        assert t.is_alive()
+        q.get().release()
+        t.join()
+        q.finish()
+        assert len(list(q)) == 1
+
+
+def _consume(q, results):
+    n = 0
+    for record in q:
+        n += len(record.particles)
+    results.put(n)
+
+
+@pytest.mark.parametrize("start_method", ("fork", "spawn"))
+def test_EventQueue_processes(start_method):
+    if start_method not in mp.get_all_start_methods():
+        pytest.skip()
+    ctx = mp.get_context(start_method)
+    evt = make_evt()
+    nevent = 20
+    with hep.EventQueue(slots=4, slot_size=1 << 14, ctx=ctx) as q:
+        results = ctx.SimpleQueue()
+        workers = [ctx.Process(target=_consume, args=(q, results)) for _ in range(3)]
+        for w in workers:
+            w.start()
+        for i in range(nevent):
+            evt.event_number = i
+            q.put(evt)
+        q.finish()
+        for w in workers:
+            w.join()
+            assert w.exitcode == 0
+        total = sum(results.get() for _ in workers)
+    assert total == nevent * len(evt.particles)
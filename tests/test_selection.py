@@ -0,0 +1,63 @@
+import pyhepmc as hep
+from pyhepmc.selection import Select, pid, status, pt, e, eta, px
+from pathlib import Path
+import numpy as np
+from numpy.testing import assert_equal, assert_allclose
+import pytest
+
+
+@pytest.fixture()
+def events():
+    with hep.open(Path(__file__).parent / "pythia6.dat") as f:
+        evt = f.read()
+    return [evt, hep.GenEvent(), evt]
+
+
+def test_select(events):
+    evt = events[0]
+    sel = Select((abs(pid) == 2212) & (status == 1) | (pt > 1.0))
+
+    def cut(p):
+        return (abs(p.pid) == 2212 and p.status == 1) or p.momentum.pt() > 1.0
+
+    expected = [cut(p) for p in evt.particles]
+    assert_equal(sel.mask(evt), expected)
+    assert sel.count(evt) == sum(expected)
+    es = [p.momentum.e for p in evt.particles if cut(p)]
+    assert_allclose(sel.sum(evt, e), sum(es))
+    assert sel.min(evt, "e") == min(es)
+    assert sel.max(evt, 2 * e + 1) == 2 * max(es) + 1
+
+    empty = Select(pid == 123456)
+    assert empty.count(evt) == 0
+    assert empty.sum(evt, e) == 0
+    assert np.isnan(empty.min(evt, e))
+
+    neg = Select(~(pt > 1.0) & (1 < abs(eta)))
+    expected = [
+        not p.momentum.pt() > 1.0 and 1 < abs(p.momentum.eta()) for p in evt.particles
+    ]
+    assert_equal(neg.mask(evt), expected)
+
+    expected = [-p.momentum.px / 2 - 1 < 0 for p in evt.particles]
+    assert_equal(Select(-px / 2 - 1 < 0).mask(evt), expected)
+
+
+@pytest.mark.parametrize("threads", (1, 2))
+def test_select_batch(events, threads):
+    sel = Select(status == 1, threads=threads)
+    assert_equal(sel.count(events), [sel.count(evt) for evt in events])
+    assert_equal(sel.sum(iter(events), e), [sel.sum(evt, e) for evt in events])
+    assert_equal(sel.max(events, pt), [sel.max(evt, pt) for evt in events])
+    assert_equal(sel.mask(events), np.concatenate([sel.mask(evt) for evt in events]))
+
+
+def test_select_errors():
+    with pytest.raises(TypeError):
+        Select(1 < pt < 2)
+
+    with pytest.raises(TypeError):
+        Select(pt > 1 and pid == 1)
+
+    with pytest.raises(KeyError):
+        Select(pt > "foo")